@@ -0,0 +1,325 @@
+#define DMOD_ENABLE_REGISTRATION
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "dmod.h"
+#include "dmosi.h"
+#include "dmosi_proc.h"
+
+#ifndef DMOSI_PROC_FAST_ACCESSORS
+#   define DMOSI_PROC_FAST_ACCESSORS 0
+#endif
+
+// Largest number of processes created by a single benchmark
+#define MAX_PROCESSES   4096
+
+static dmosi_process_t processes[MAX_PROCESSES];
+static char names[MAX_PROCESSES][24];
+
+// Sink that keeps the compiler from optimizing benchmarked calls away
+static volatile uintptr_t sink;
+
+/**
+ * @brief Get a monotonic timestamp in nanoseconds
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Print one benchmark result line
+ */
+static void report(const char* name, size_t param, uint64_t elapsed_ns, size_t operations)
+{
+    printf("%-28s %8zu %12zu ops %10.1f ns/op\n", name, param, operations,
+           operations ? (double)elapsed_ns / (double)operations : 0.0);
+}
+
+/**
+ * @brief Create @p count processes with unique names
+ */
+static bool create_processes(size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "bench_%zu", i);
+        processes[i] = dmosi_process_create(names[i], "bench_module", NULL);
+        if(!processes[i])
+        {
+            printf("Failed to create process %zu\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void destroy_processes(size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        dmosi_process_destroy(processes[i]);
+    }
+}
+
+// -----------------------------------------
+//
+//      Benchmark: create/destroy throughput
+//
+// -----------------------------------------
+static void bench_create_destroy(void)
+{
+    const size_t iterations = 100000;
+
+    uint64_t start = now_ns();
+    for(size_t i = 0; i < iterations; i++)
+    {
+        dmosi_process_t process = dmosi_process_create("bench_cycle", "bench_module", NULL);
+        dmosi_process_destroy(process);
+    }
+    report("create+destroy", 1, now_ns() - start, iterations);
+
+    // Same cycle with a live population, so lookups structures are not empty
+    const size_t population = 1024;
+    if(!create_processes(population))
+        return;
+    start = now_ns();
+    for(size_t i = 0; i < iterations; i++)
+    {
+        dmosi_process_t process = dmosi_process_create("bench_cycle", "bench_module", NULL);
+        dmosi_process_destroy(process);
+    }
+    report("create+destroy", population, now_ns() - start, iterations);
+    destroy_processes(population);
+
+    // Batch creation of worker pools
+    const size_t batch = 128;
+    const size_t rounds = 500;
+    start = now_ns();
+    for(size_t r = 0; r < rounds; r++)
+    {
+        if(dmosi_process_create_many("bench_worker", "bench_module", NULL, batch, processes) != 0)
+        {
+            printf("Failed to create process batch\n");
+            return;
+        }
+        destroy_processes(batch);
+    }
+    report("create_many+destroy", batch, now_ns() - start, rounds * batch);
+}
+
+// -----------------------------------------
+//
+//      Benchmark: lookup latency vs process count
+//
+// -----------------------------------------
+static void bench_find(void)
+{
+    static const size_t counts[] = { 16, 256, MAX_PROCESSES };
+    const size_t lookups = 200000;
+
+    for(size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        size_t count = counts[c];
+        if(!create_processes(count))
+            return;
+
+        uint64_t start = now_ns();
+        for(size_t i = 0; i < lookups; i++)
+        {
+            dmosi_process_t process = processes[(i * 7919) % count];
+            sink = (uintptr_t)dmosi_process_find_by_id(dmosi_process_get_id(process));
+        }
+        report("find_by_id", count, now_ns() - start, lookups);
+
+        start = now_ns();
+        for(size_t i = 0; i < lookups; i++)
+        {
+            sink = (uintptr_t)dmosi_process_find_by_name(names[(i * 7919) % count]);
+        }
+        report("find_by_name", count, now_ns() - start, lookups);
+
+        start = now_ns();
+        for(size_t i = 0; i < lookups; i++)
+        {
+            sink = (uintptr_t)dmosi_process_find_by_id(0x7FFFFFF0u + (dmosi_process_id_t)(i & 7));
+        }
+        report("find_by_id (miss)", count, now_ns() - start, lookups);
+
+        destroy_processes(count);
+    }
+}
+
+// -----------------------------------------
+//
+//      Benchmark: getters
+//
+// -----------------------------------------
+static void bench_getters(void)
+{
+    const size_t iterations = 1000000;
+    dmosi_process_t process = dmosi_process_create("bench_getters", "bench_module", NULL);
+
+    uint64_t start = now_ns();
+    for(size_t i = 0; i < iterations; i++)
+    {
+        sink = dmosi_process_get_id(process);
+        sink = (uintptr_t)dmosi_process_get_name(process);
+        sink = (uintptr_t)dmosi_process_get_state(process);
+        sink = dmosi_process_get_uid(process);
+    }
+    report(DMOSI_PROC_FAST_ACCESSORS ? "getters x4 (fast)" : "getters x4 (checked)", 1, now_ns() - start, iterations);
+
+    dmosi_process_destroy(process);
+}
+
+// -----------------------------------------
+//
+//      Benchmark: enumeration
+//
+// -----------------------------------------
+static bool count_visitor(dmosi_process_t process, void* context)
+{
+    (void)process;
+    (*(size_t*)context)++;
+    return true;
+}
+
+static void bench_enumeration(void)
+{
+    const size_t count = 1024;
+    const size_t rounds = 2000;
+    static dmosi_process_t listed[1024];
+    if(!create_processes(count))
+        return;
+
+    uint64_t start = now_ns();
+    for(size_t r = 0; r < rounds; r++)
+    {
+        sink = dmosi_process_get_all(listed, count);
+    }
+    report("get_all", count, now_ns() - start, rounds);
+
+    size_t visited = 0;
+    start = now_ns();
+    for(size_t r = 0; r < rounds; r++)
+    {
+        dmosi_process_for_each(count_visitor, &visited);
+    }
+    report("for_each", count, now_ns() - start, rounds);
+    sink = visited;
+
+    destroy_processes(count);
+}
+
+// -----------------------------------------
+//
+//      Benchmark: kill latency
+//
+// -----------------------------------------
+static void bench_kill(void)
+{
+    // The host build has no scheduler, so this measures the bookkeeping
+    // around the thread layer rather than the cost of killing threads
+    const size_t count = 4096;
+    if(!create_processes(count))
+        return;
+
+    uint64_t start = now_ns();
+    for(size_t i = 0; i < count; i++)
+    {
+        dmosi_process_kill(processes[i], 1);
+    }
+    report("kill (no threads)", count, now_ns() - start, count);
+
+    destroy_processes(count);
+}
+
+// -----------------------------------------
+//
+//      Benchmark: wait wakeup latency
+//
+// -----------------------------------------
+typedef struct
+{
+    dmosi_process_t process;
+    uint64_t woken_ns;
+} waiter_t;
+
+static void* waiter_thread(void* arg)
+{
+    waiter_t* waiter = arg;
+    dmosi_process_wait(waiter->process, -1);
+    waiter->woken_ns = now_ns();
+    return NULL;
+}
+
+static void bench_wait(void)
+{
+    const size_t rounds = 20;
+    uint64_t total = 0;
+    uint64_t worst = 0;
+
+    for(size_t r = 0; r < rounds; r++)
+    {
+        waiter_t waiter = { dmosi_process_create("bench_wait", "bench_module", NULL), 0 };
+        pthread_t thread;
+        pthread_create(&thread, NULL, waiter_thread, &waiter);
+
+        // Give the waiter time to block
+        struct timespec pause = { 0, 5 * 1000 * 1000 };
+        nanosleep(&pause, NULL);
+
+        uint64_t killed = now_ns();
+        dmosi_process_kill(waiter.process, 0);
+        pthread_join(thread, NULL);
+
+        uint64_t latency = waiter.woken_ns - killed;
+        total += latency;
+        worst = latency > worst ? latency : worst;
+        dmosi_process_destroy(waiter.process);
+    }
+    report("wait wakeup (mean)", 1, total, rounds);
+    report("wait wakeup (max)", 1, worst, 1);
+
+    // Fast path: process already terminated
+    const size_t iterations = 100000;
+    dmosi_process_t process = dmosi_process_create("bench_wait_done", "bench_module", NULL);
+    dmosi_process_kill(process, 0);
+    uint64_t start = now_ns();
+    for(size_t i = 0; i < iterations; i++)
+    {
+        sink = (uintptr_t)dmosi_process_wait(process, 0);
+    }
+    report("wait (terminated)", 1, now_ns() - start, iterations);
+    dmosi_process_destroy(process);
+}
+
+// -----------------------------------------
+//
+//      Main function
+//
+// -----------------------------------------
+int main(void)
+{
+    printf("========================================\n");
+    printf("  DMOSI Process Benchmarks\n");
+    printf("========================================\n");
+    printf("%-28s %8s %16s %16s\n", "benchmark", "size", "operations", "latency");
+
+    bench_create_destroy();
+    bench_find();
+    bench_getters();
+    bench_enumeration();
+    bench_kill();
+    bench_wait();
+
+    printf("========================================\n");
+    return 0;
+}
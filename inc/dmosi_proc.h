@@ -0,0 +1,843 @@
+#ifndef DMOSI_PROC_H
+#define DMOSI_PROC_H
+
+#include "dmosi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dmosi_proc.h
+ * @brief Extensions of the DMOSI process interface provided by dmosi-proc
+ *
+ * The functions declared here complement the process API from dmosi.h
+ * and are only available when linking against dmosi_proc.
+ */
+
+//==============================================================================
+//                              PROCESS TREE
+//==============================================================================
+
+/**
+ * @brief Get the most recently created child of a process
+ *
+ * Together with dmosi_process_get_next_sibling this allows walking the
+ * children of a process without copying handles.
+ *
+ * @param process Parent process
+ * @return dmosi_process_t First child or NULL if the process has no children
+ */
+dmosi_process_t dmosi_process_get_first_child( dmosi_process_t process );
+
+/**
+ * @brief Get the next child of the same parent
+ *
+ * @param process Child process
+ * @return dmosi_process_t Next sibling or NULL if this is the last child
+ */
+dmosi_process_t dmosi_process_get_next_sibling( dmosi_process_t process );
+
+/**
+ * @brief Get the children of a process
+ *
+ * Follows the same convention as dmosi_thread_get_all: call with
+ * children set to NULL to get the number of children, then call again
+ * with a buffer of that size.
+ *
+ * @param process Parent process
+ * @param children Buffer for the child handles (may be NULL)
+ * @param max_count Capacity of the buffer
+ * @return size_t Number of children (when children is NULL) or number of handles written
+ */
+size_t dmosi_process_get_children( dmosi_process_t process, dmosi_process_t* children, size_t max_count );
+
+/**
+ * @brief Kill a process together with all of its descendants
+ *
+ * Every process in the subtree is killed with the given status. The
+ * walk stops at the first failure. Processes that have already
+ * terminated keep their exit status, but their descendants are killed.
+ *
+ * Auto-reaped processes are queued for the reaper only after the whole
+ * subtree has been killed.
+ *
+ * @note The subtree must not be modified by create/destroy while it is
+ * being killed, which includes auto-reaped processes of the subtree that
+ * were killed before the call.
+ *
+ * @param process Root of the subtree
+ * @param status Exit status passed to every killed process
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_process_kill_tree( dmosi_process_t process, int status );
+
+//==============================================================================
+//                              BATCH CREATION
+//==============================================================================
+
+/**
+ * @brief Create several processes of the same module at once
+ *
+ * The processes are named @p name_prefix followed by their index in the
+ * batch ("worker0", "worker1", ...), receive a contiguous range of
+ * process IDs, and share a single allocation that is released when the
+ * last of them is destroyed. Either all processes are created or none.
+ *
+ * @param name_prefix Prefix of the process names
+ * @param module_name Name of the associated module (NULL = system module)
+ * @param parent Parent process of every created process (may be NULL, ignored if it is being destroyed)
+ * @param count Number of processes to create
+ * @param processes Buffer receiving @p count process handles
+ * @return int 0 on success, -EINVAL on invalid arguments, -ENOMEM on allocation failure
+ */
+int dmosi_process_create_many( const char* name_prefix, const char* module_name, dmosi_process_t parent, size_t count, dmosi_process_t* processes );
+
+//==============================================================================
+//                              WORKING DIRECTORY
+//==============================================================================
+
+/**
+ * @brief Copy the working directory of a process into a caller buffer
+ *
+ * dmosi_process_get_pwd reads without locking and readers are not
+ * tracked: the returned string is only kept intact until the second
+ * following dmosi_process_set_pwd, after which it may be freed or, for
+ * pooled processes, overwritten while it is read. This function copies
+ * the string inside the critical section and is safe for readers that
+ * may race with any number of updates.
+ *
+ * @param process Process handle
+ * @param buffer Buffer receiving the NUL-terminated path
+ * @param size Size of the buffer
+ * @return int 0 on success, -EINVAL on invalid arguments, -ERANGE if the
+ *             buffer is too small (the buffer is left unchanged)
+ */
+int dmosi_process_copy_pwd( dmosi_process_t process, char* buffer, size_t size );
+
+//==============================================================================
+//                              WAITING ON SEVERAL PROCESSES
+//==============================================================================
+
+/**
+ * @brief Wait until any process of a set terminates
+ *
+ * The caller blocks once for the whole set and is woken by the first
+ * termination, so one supervisor thread can reap many processes.
+ *
+ * @param processes Processes to wait for
+ * @param count Number of processes
+ * @param timeout_ms Timeout in milliseconds (negative = infinite, 0 = check only)
+ * @param exit_status Receives the exit status of the terminated process (may be NULL)
+ * @return int Index of a terminated process in @p processes, -EINVAL on invalid
+ *             arguments, -ENOMEM on allocation failure, -ETIMEDOUT on timeout
+ */
+int dmosi_process_wait_any( const dmosi_process_t* processes, size_t count, int32_t timeout_ms, int* exit_status );
+
+/**
+ * @brief Wait until every process of a set has terminated
+ *
+ * The caller is woken once, by the last termination.
+ *
+ * @param processes Processes to wait for
+ * @param count Number of processes
+ * @param timeout_ms Timeout in milliseconds (negative = infinite, 0 = check only)
+ * @return int 0 when all processes have terminated, -EINVAL on invalid arguments,
+ *             -ENOMEM on allocation failure, -ETIMEDOUT on timeout
+ */
+int dmosi_process_wait_all( const dmosi_process_t* processes, size_t count, int32_t timeout_ms );
+
+//==============================================================================
+//                              PROCESS GROUPS
+//==============================================================================
+
+/**
+ * @brief Move a process into a process group
+ *
+ * A group is identified by the PID of its leader. New processes join the
+ * group of their parent; processes without a parent lead a group of
+ * their own. The PID of a group is not reused while the group has
+ * members, even after its leader has been destroyed. Members are counted
+ * per PID in the handle table, so the groups of PIDs above
+ * DMOSI_PROC_PID_MAX can only be led, not joined.
+ *
+ * @param process Process handle
+ * @param group Group to join (0 = start a new group led by the process)
+ * @return int 0 on success, -EINVAL on an invalid handle, -ESRCH if the
+ *             group has no members
+ */
+int dmosi_process_set_group( dmosi_process_t process, dmosi_process_id_t group );
+
+/**
+ * @brief Get the process group of a process
+ *
+ * @param process Process handle
+ * @return dmosi_process_id_t Group of the process or 0 for an invalid handle
+ */
+dmosi_process_id_t dmosi_process_get_group( dmosi_process_t process );
+
+/**
+ * @brief Kill every process of a group
+ *
+ * Works like dmosi_process_kill_module: one pass over the threads and
+ * one critical section for the whole group.
+ *
+ * @param group Process group
+ * @param status Exit status passed to every killed process
+ * @return int Number of processes killed, -EINVAL for group 0, -ENOMEM or -EFAULT on failure
+ */
+int dmosi_process_kill_group( dmosi_process_id_t group, int status );
+
+/**
+ * @brief Wait until every process of a group has terminated
+ *
+ * The running members are counted, a buffer for them is allocated
+ * outside the critical section (and regrown if members joined meanwhile),
+ * and they are then collected in one critical section and awaited with a
+ * single wakeup, like dmosi_process_wait_all. Processes that join the
+ * group after they have been collected are not waited for.
+ *
+ * @param group Process group
+ * @param timeout_ms Timeout in milliseconds (negative = infinite, 0 = check only)
+ * @return int 0 when the group has terminated, -EINVAL for group 0,
+ *             -ENOMEM on allocation failure, -ETIMEDOUT on timeout
+ */
+int dmosi_process_wait_group( dmosi_process_id_t group, int32_t timeout_ms );
+
+//==============================================================================
+//                              TERMINATION CALLBACKS
+//==============================================================================
+
+/**
+ * @brief Callback invoked when a process terminates
+ *
+ * Runs once, outside the critical section, in the thread that killed or
+ * destroyed the process. It must be short, e.g. post an event to a
+ * queue. When fired by dmosi_process_destroy the handle is already
+ * invalid and may only be compared against stored handles.
+ *
+ * @param process Terminated process
+ * @param exit_status Exit status of the process
+ * @param context User context passed at registration
+ */
+typedef void (*dmosi_process_exit_callback_t)( dmosi_process_t process, int exit_status, void* context );
+
+/**
+ * @brief Register a callback fired when a process terminates
+ *
+ * The callback fires when dmosi_process_kill, dmosi_process_kill_module
+ * or dmosi_process_destroy moves the process to
+ * DMOSI_PROCESS_STATE_TERMINATED. If the process has already terminated
+ * the callback is invoked before this function returns.
+ *
+ * @param process Process to watch
+ * @param callback Function to call
+ * @param context User context passed to the callback
+ * @return int 0 on success, -EINVAL on invalid arguments, -ENOMEM on allocation failure
+ */
+int dmosi_process_add_exit_callback( dmosi_process_t process, dmosi_process_exit_callback_t callback, void* context );
+
+/**
+ * @brief Unregister a callback that has not fired yet
+ *
+ * @param process Watched process
+ * @param callback Registered function
+ * @param context Context given at registration
+ * @return int 0 on success, -EINVAL on invalid arguments, -ENOENT if no such registration is pending
+ */
+int dmosi_process_remove_exit_callback( dmosi_process_t process, dmosi_process_exit_callback_t callback, void* context );
+
+//==============================================================================
+//                              DEFERRED DESTRUCTION
+//==============================================================================
+
+/**
+ * @brief Hand a process over to the reaper
+ *
+ * Queues the process on a lock-free queue and returns at once; the
+ * teardown normally done by dmosi_process_destroy happens later in
+ * dmosi_process_reap, usually from the reaper thread. The caller must
+ * not use the handle afterwards.
+ *
+ * @param process Process to destroy
+ * @return int 0 on success, -EINVAL on an invalid handle, -EALREADY if the process is already queued
+ */
+int dmosi_process_destroy_deferred( dmosi_process_t process );
+
+/**
+ * @brief Let the reaper destroy a process as soon as it terminates
+ *
+ * Once enabled, the process is queued for the reaper when it is killed,
+ * so terminated processes nobody destroys do not leak. Children created
+ * afterwards inherit the setting, which also covers processes orphaned
+ * by the destruction of their parent. The owner must not destroy an
+ * auto-reaped process itself once it may have terminated.
+ *
+ * @param process Process handle
+ * @param enable true to enable auto reaping, false to disable it
+ * @return int 0 on success, -EINVAL on an invalid handle
+ */
+int dmosi_process_set_auto_reap( dmosi_process_t process, bool enable );
+
+/**
+ * @brief Destroy queued processes
+ *
+ * @param max_count Maximum number of processes to destroy
+ * @return size_t Number of processes destroyed
+ */
+size_t dmosi_process_reap( size_t max_count );
+
+/**
+ * @brief Entry function of the reaper thread
+ *
+ * Never returns. Create a low-priority thread with this entry to move
+ * process teardown off the callers of dmosi_process_destroy_deferred. The
+ * thread sleeps until processes are queued and destroys them in batches.
+ *
+ * @param arg Unused
+ */
+void dmosi_process_reaper_thread( void* arg );
+
+//==============================================================================
+//                              HANDLES
+//==============================================================================
+
+/**
+ * @brief Generation-tagged reference to a process
+ *
+ * Combines the PID (low 32 bits) with the generation of its slot in the
+ * handle table (high 32 bits). The generation changes whenever a process
+ * is registered under or removed from the PID, so a handle kept after
+ * dmosi_process_destroy or dmosi_process_set_id never resolves again,
+ * even when the PID or the memory of the process is reused.
+ */
+typedef uint64_t dmosi_process_handle_t;
+
+#define DMOSI_PROCESS_HANDLE_INVALID    0   /**< Handle that never refers to a process */
+
+/**
+ * @brief Get the generation-tagged handle of a process
+ *
+ * @param process Process handle
+ * @return dmosi_process_handle_t Handle or DMOSI_PROCESS_HANDLE_INVALID for an
+ *         invalid process or a PID above DMOSI_PROC_PID_MAX
+ */
+dmosi_process_handle_t dmosi_process_get_handle( dmosi_process_t process );
+
+/**
+ * @brief Check whether a handle still refers to a live process
+ *
+ * Lock-free: one bounds check and one compare in the handle table,
+ * without touching the process itself, so it is safe on handles of
+ * destroyed processes.
+ *
+ * @param handle Generation-tagged handle
+ * @return bool true if the process is still registered
+ */
+bool dmosi_process_handle_is_valid( dmosi_process_handle_t handle );
+
+/**
+ * @brief Resolve a generation-tagged handle to the process it refers to
+ *
+ * @note Lock-free. The process can still be destroyed right after the
+ * call returns; callers that race with destroy must keep it alive by
+ * other means.
+ *
+ * @param handle Generation-tagged handle
+ * @return dmosi_process_t Process or NULL if the handle is stale
+ */
+dmosi_process_t dmosi_process_from_handle( dmosi_process_handle_t handle );
+
+//==============================================================================
+//                              ENUMERATION
+//==============================================================================
+
+/**
+ * @brief Callback invoked for each process by dmosi_process_for_each
+ *
+ * @param process Visited process
+ * @param context User context passed to dmosi_process_for_each
+ * @return bool true to continue the enumeration, false to stop it
+ */
+typedef bool (*dmosi_process_visitor_t)( dmosi_process_t process, void* context );
+
+/**
+ * @brief Get all existing processes
+ *
+ * Follows the same convention as dmosi_thread_get_all: call with
+ * processes set to NULL to get the number of processes, then call again
+ * with a buffer of that size.
+ *
+ * @param processes Buffer for the process handles (may be NULL)
+ * @param max_count Capacity of the buffer
+ * @return size_t Number of processes (when processes is NULL) or number of handles written
+ */
+size_t dmosi_process_get_all( dmosi_process_t* processes, size_t max_count );
+
+/**
+ * @brief Visit every existing process exactly once without copying handles
+ *
+ * @note The visitor runs inside the critical section. It must be short
+ * and must not create or destroy processes.
+ *
+ * @param visitor Function called for each process
+ * @param context User context passed to the visitor
+ * @return size_t Number of processes visited
+ */
+size_t dmosi_process_for_each( dmosi_process_visitor_t visitor, void* context );
+
+//==============================================================================
+//                              MODULES
+//==============================================================================
+
+/**
+ * @brief Handle of an interned module name
+ *
+ * Processes of the same module share one interned module name. Module
+ * names stay interned once used, so the handle of a module never changes
+ * and processes can be matched by module with an integer comparison
+ * instead of a string comparison.
+ */
+typedef uint32_t dmosi_process_module_t;
+
+#define DMOSI_PROCESS_MODULE_INVALID    0   /**< Handle that never refers to a module */
+
+/**
+ * @brief Get the module handle of a process
+ *
+ * @param process Process handle
+ * @return dmosi_process_module_t Module handle or DMOSI_PROCESS_MODULE_INVALID for an invalid process
+ */
+dmosi_process_module_t dmosi_process_get_module( dmosi_process_t process );
+
+/**
+ * @brief Get the handle of a module by name
+ *
+ * @param module_name Name of the module
+ * @return dmosi_process_module_t Module handle or DMOSI_PROCESS_MODULE_INVALID if no process of the module was created yet
+ */
+dmosi_process_module_t dmosi_process_find_module( const char* module_name );
+
+/**
+ * @brief Get all processes of a module
+ *
+ * Follows the count-then-fill convention of dmosi_process_get_all. The
+ * count is kept by the interned module name, so calling with processes
+ * set to NULL does not scan the registry. Processes that are being
+ * destroyed are counted until dmosi_process_destroy returns.
+ *
+ * @param module Module handle
+ * @param processes Buffer for the process handles (may be NULL)
+ * @param max_count Capacity of the buffer
+ * @return size_t Number of processes of the module (when processes is NULL) or number of handles written
+ */
+size_t dmosi_process_get_by_module( dmosi_process_module_t module, dmosi_process_t* processes, size_t max_count );
+
+/**
+ * @brief Kill every process of a module
+ *
+ * Intended for module unload. The threads of all processes of the module
+ * are found with a single pass over the thread list, and the processes
+ * are marked as terminated within one critical section. A thread that
+ * fails to die does not stop the remaining threads and processes from
+ * being killed. Processes that have already terminated keep their exit
+ * status and are not counted.
+ *
+ * @param module Module handle
+ * @param status Exit status passed to every killed process
+ * @return int Number of processes killed, -ENOMEM if the thread list cannot be
+ *             fetched, -EFAULT if a thread could not be killed
+ */
+int dmosi_process_kill_module( dmosi_process_module_t module, int status );
+
+//==============================================================================
+//                              QUERIES
+//==============================================================================
+
+/**
+ * @brief Criteria selected by dmosi_process_query_t::fields
+ */
+typedef enum
+{
+    DMOSI_PROCESS_QUERY_STATE   = 1u << 0,  /**< Match dmosi_process_query_t::state */
+    DMOSI_PROCESS_QUERY_UID     = 1u << 1,  /**< Match dmosi_process_query_t::uid */
+    DMOSI_PROCESS_QUERY_GROUP   = 1u << 2,  /**< Match dmosi_process_query_t::group */
+    DMOSI_PROCESS_QUERY_PARENT  = 1u << 3,  /**< Match dmosi_process_query_t::parent (NULL = root processes) */
+    DMOSI_PROCESS_QUERY_MODULE  = 1u << 4,  /**< Match dmosi_process_query_t::module */
+    DMOSI_PROCESS_QUERY_NAME    = 1u << 5,  /**< Match dmosi_process_query_t::name exactly */
+} dmosi_process_query_field_t;
+
+/**
+ * @brief Set of criteria a process has to meet to be returned by a query
+ *
+ * Only the criteria selected in fields are compared; a query with no
+ * fields matches every process. Integer criteria are compared first and
+ * the name is compared last, by cached hash before the string itself.
+ */
+typedef struct
+{
+    uint32_t fields;                    /**< Bitwise OR of dmosi_process_query_field_t */
+    dmosi_process_state_t state;        /**< Required state */
+    dmosi_user_id_t uid;                /**< Required user ID */
+    dmosi_process_id_t group;           /**< Required process group */
+    dmosi_process_t parent;             /**< Required parent process */
+    dmosi_process_module_t module;      /**< Required module handle */
+    const char* name;                   /**< Required process name */
+} dmosi_process_query_t;
+
+/**
+ * @brief Get all processes matching a query
+ *
+ * Follows the count-then-fill convention of dmosi_process_get_all. The
+ * registry is scanned once, inside a single critical section.
+ *
+ * @param query Criteria to match
+ * @param processes Buffer for the process handles (may be NULL)
+ * @param max_count Capacity of the buffer
+ * @return size_t Number of matching processes (when processes is NULL) or number of handles written
+ */
+size_t dmosi_process_query( const dmosi_process_query_t* query, dmosi_process_t* processes, size_t max_count );
+
+/**
+ * @brief Visit every process matching a query without copying handles
+ *
+ * @note The visitor runs inside the critical section, with the same
+ * restrictions as for dmosi_process_for_each.
+ *
+ * @param query Criteria to match
+ * @param visitor Function called for each matching process
+ * @param context User context passed to the visitor
+ * @return size_t Number of processes visited
+ */
+size_t dmosi_process_query_each( const dmosi_process_query_t* query, dmosi_process_visitor_t visitor, void* context );
+
+//==============================================================================
+//                              THREAD REGISTRY
+//==============================================================================
+
+/**
+ * @brief Link of a thread in the thread list of its process
+ *
+ * Owned by the thread layer, typically embedded in its thread structure,
+ * and only modified by dmosi_process_attach_thread and
+ * dmosi_process_detach_thread.
+ */
+typedef struct dmosi_process_thread_link
+{
+    dmosi_thread_t thread;                          /**< Attached thread */
+    dmosi_process_t process;                        /**< Process the thread is attached to (NULL = detached) */
+    struct dmosi_process_thread_link* prev;         /**< Previous thread of the process */
+    struct dmosi_process_thread_link* next;         /**< Next thread of the process */
+    bool killed;                                    /**< The process has killed this thread or is killing it */
+    bool kill_failed;                               /**< Killing the thread failed, the next kill retries it */
+} dmosi_process_thread_link_t;
+
+/**
+ * @brief Attach a thread to a process
+ *
+ * Intended to be called by the thread layer when it creates a thread.
+ * Once any thread has been attached, processes look up their threads in
+ * their own lists instead of asking the thread layer, so a thread layer
+ * that uses the hooks must attach every thread it creates.
+ *
+ * @param process Process the thread belongs to
+ * @param thread Thread handle
+ * @param link Link storage that stays valid until the thread is detached
+ * @return int 0 on success, -EINVAL on invalid arguments or a process that is being destroyed
+ */
+int dmosi_process_attach_thread( dmosi_process_t process, dmosi_thread_t thread, dmosi_process_thread_link_t* link );
+
+/**
+ * @brief Detach a thread from its process
+ *
+ * Intended to be called by the thread layer when a thread exits. Links
+ * of destroyed processes are detached by destroy, so detaching them
+ * again is a no-op.
+ *
+ * @param link Link passed to dmosi_process_attach_thread
+ */
+void dmosi_process_detach_thread( dmosi_process_thread_link_t* link );
+
+/**
+ * @brief Get the number of threads attached to a process
+ *
+ * Falls back to asking the thread layer when the attach hooks are not used.
+ *
+ * @param process Process to query
+ * @return size_t Number of threads of the process
+ */
+size_t dmosi_process_get_thread_count( dmosi_process_t process );
+
+//==============================================================================
+//                              SCHEDULING
+//==============================================================================
+
+#define DMOSI_PROCESS_PRIORITY_UNSET    INT32_MIN   /**< The process does not impose a priority */
+#define DMOSI_PROCESS_AFFINITY_ANY      0u          /**< The process is not pinned to any CPUs */
+
+/**
+ * @brief Apply scheduling attributes to one thread
+ *
+ * Installed by the thread layer, which knows how to map the priority
+ * class and the CPU mask onto its scheduler.
+ *
+ * @param thread Thread handle
+ * @param priority Priority class of the process (may be DMOSI_PROCESS_PRIORITY_UNSET)
+ * @param affinity CPU mask of the process, bit n = CPU n (may be DMOSI_PROCESS_AFFINITY_ANY)
+ * @return int 0 on success, non-zero on failure
+ */
+typedef int (*dmosi_process_sched_handler_t)( dmosi_thread_t thread, int priority, uint32_t affinity );
+
+/**
+ * @brief Install the handler that applies process scheduling attributes to threads
+ *
+ * Threads attached through dmosi_process_attach_thread get the attributes
+ * of their process applied on attach, so threads created in a process
+ * inherit its priority class and affinity.
+ *
+ * @param handler Handler (NULL = attributes are only stored)
+ */
+void dmosi_process_set_sched_handler( dmosi_process_sched_handler_t handler );
+
+/**
+ * @brief Set the priority class and CPU affinity of a process
+ *
+ * Child processes inherit both attributes at creation. The new values
+ * are re-applied to every existing thread of the process in one batch,
+ * collected under one critical section and applied outside of it.
+ *
+ * @param process Process handle
+ * @param priority Priority class (DMOSI_PROCESS_PRIORITY_UNSET = none)
+ * @param affinity CPU mask (DMOSI_PROCESS_AFFINITY_ANY = none)
+ * @return int 0 on success, -EINVAL on an invalid handle, -EFAULT if a thread could not be updated
+ */
+int dmosi_process_set_sched( dmosi_process_t process, int priority, uint32_t affinity );
+
+/**
+ * @brief Set the priority class of a process, keeping its affinity
+ *
+ * @see dmosi_process_set_sched
+ */
+int dmosi_process_set_priority( dmosi_process_t process, int priority );
+
+/**
+ * @brief Set the CPU affinity of a process, keeping its priority class
+ *
+ * @see dmosi_process_set_sched
+ */
+int dmosi_process_set_affinity( dmosi_process_t process, uint32_t affinity );
+
+/**
+ * @brief Get the priority class of a process
+ *
+ * @param process Process handle
+ * @return int Priority class or DMOSI_PROCESS_PRIORITY_UNSET
+ */
+int dmosi_process_get_priority( dmosi_process_t process );
+
+/**
+ * @brief Get the CPU affinity of a process
+ *
+ * @param process Process handle
+ * @return uint32_t CPU mask or DMOSI_PROCESS_AFFINITY_ANY
+ */
+uint32_t dmosi_process_get_affinity( dmosi_process_t process );
+
+//==============================================================================
+//                              RESOURCE ACCOUNTING
+//==============================================================================
+
+/**
+ * @brief Snapshot of the resources used by a process
+ *
+ * Accounting is caller-driven: the counters and the memory quota only
+ * cover what the memory layer and the scheduler report through the
+ * functions below. dmosi_proc never charges its own allocations (process
+ * control blocks, names, working directory strings, wait sets, exit
+ * callbacks), so they neither show up in the usage of a process nor
+ * count against its quota.
+ */
+typedef struct
+{
+    size_t allocated_bytes;     /**< Bytes currently allocated on behalf of the process */
+    size_t peak_bytes;          /**< Highest number of bytes allocated at once */
+    size_t memory_limit;        /**< Memory quota of the process (0 = unlimited) */
+    size_t thread_count;        /**< Number of live threads of the process */
+    uint64_t cpu_ticks;         /**< Accumulated CPU time in scheduler ticks */
+} dmosi_process_usage_t;
+
+/**
+ * @brief Charge an allocation to a process
+ *
+ * Intended to be called by the memory layer next to Dmod_MallocEx.
+ * Lock-free and safe to call on hot paths.
+ *
+ * @param process Process the memory belongs to
+ * @param size Number of bytes allocated
+ */
+void dmosi_process_account_alloc( dmosi_process_t process, size_t size );
+
+/**
+ * @brief Charge an allocation to a process if it fits into its memory quota
+ *
+ * Intended to be called by the memory layer before Dmod_MallocEx, so that
+ * a process over its quota fails fast without touching the shared heap.
+ * If the allocation itself then fails, the reservation is returned with
+ * dmosi_process_account_free. Lock-free.
+ *
+ * @param process Process the memory belongs to
+ * @param size Number of bytes to allocate
+ * @return int 0 if the bytes were charged, -ENOMEM if they exceed the quota,
+ *             -EINVAL on an invalid handle
+ */
+int dmosi_process_reserve_memory( dmosi_process_t process, size_t size );
+
+/**
+ * @brief Set the memory quota of a process
+ *
+ * The quota is enforced by dmosi_process_reserve_memory only, so it
+ * limits the allocations the memory layer reports and none made by
+ * dmosi_proc itself. Lowering the quota below the current usage does not
+ * free anything; further reservations fail until enough memory has been
+ * released.
+ *
+ * @param process Process handle
+ * @param limit Maximum number of bytes charged to the process (0 = unlimited)
+ * @return int 0 on success, -EINVAL on an invalid handle
+ */
+int dmosi_process_set_memory_limit( dmosi_process_t process, size_t limit );
+
+/**
+ * @brief Release an allocation previously charged to a process
+ *
+ * @param process Process the memory belongs to
+ * @param size Number of bytes freed
+ */
+void dmosi_process_account_free( dmosi_process_t process, size_t size );
+
+/**
+ * @brief Charge CPU time to a process
+ *
+ * Intended to be called from the scheduler tick for the process of the
+ * running thread.
+ *
+ * @param process Process that was running
+ * @param ticks Number of ticks to add
+ */
+void dmosi_process_account_cpu( dmosi_process_t process, uint32_t ticks );
+
+/**
+ * @brief Get the resource usage of a process
+ *
+ * @param process Process to query
+ * @param usage Filled with the current usage
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_process_get_usage( dmosi_process_t process, dmosi_process_usage_t* usage );
+
+//==============================================================================
+//                              STATISTICS EXPORT
+//==============================================================================
+
+#define DMOSI_PROCESS_STATS_NAME_LENGTH 16  /**< Size of the name field of an export record (names are truncated) */
+
+/**
+ * @brief Fixed-size export record of one process
+ *
+ * Fields are ordered by size so that the record has no padding and can
+ * be sent as-is to a monitoring agent of the same byte order.
+ */
+typedef struct
+{
+    uint64_t cpu_ticks;                             /**< Accumulated CPU time in scheduler ticks */
+    uint64_t allocated_bytes;                       /**< Bytes currently allocated on behalf of the process */
+    uint64_t peak_bytes;                            /**< Highest number of bytes allocated at once */
+    dmosi_process_id_t pid;                         /**< Process ID */
+    dmosi_process_id_t parent_pid;                  /**< Process ID of the parent (0 = none) */
+    dmosi_process_id_t group;                       /**< Process group */
+    dmosi_user_id_t uid;                            /**< User ID */
+    dmosi_process_module_t module;                  /**< Module handle */
+    uint32_t thread_count;                          /**< Number of live threads */
+    int32_t exit_status;                            /**< Exit status */
+    uint32_t state;                                 /**< dmosi_process_state_t */
+    char name[DMOSI_PROCESS_STATS_NAME_LENGTH];     /**< Process name, truncated and NUL terminated */
+} dmosi_process_stats_t;
+
+/**
+ * @brief Export a snapshot of every process in one call
+ *
+ * Follows the count-then-fill convention of dmosi_process_get_all. All
+ * records are written in one pass over the registry inside a single
+ * critical section, so the snapshot is consistent. Without the thread
+ * registry, thread counts come from one dmosi_thread_get_all pass made
+ * before the critical section.
+ *
+ * @param stats Buffer for the records (may be NULL)
+ * @param max_count Capacity of the buffer
+ * @return size_t Number of processes (when stats is NULL) or number of records written
+ */
+size_t dmosi_process_export_stats( dmosi_process_stats_t* stats, size_t max_count );
+
+//==============================================================================
+//                              LIFECYCLE TRACING
+//==============================================================================
+
+/**
+ * @brief Process lifecycle events recorded in the trace ring
+ */
+typedef enum
+{
+    DMOSI_PROCESS_TRACE_CREATE = 0,     /**< Process created (arg unused) */
+    DMOSI_PROCESS_TRACE_KILL,           /**< Process killed (arg = status) */
+    DMOSI_PROCESS_TRACE_DESTROY,        /**< Process destroyed (arg = exit status) */
+    DMOSI_PROCESS_TRACE_WAIT_ENTER,     /**< Wait started (arg = timeout in ms) */
+    DMOSI_PROCESS_TRACE_WAIT_EXIT,      /**< Wait finished (arg = result) */
+    DMOSI_PROCESS_TRACE_FIND,           /**< Lookup by name or ID (pid = 0 if by name and not found) */
+} dmosi_process_trace_event_t;
+
+/**
+ * @brief Binary record of a lifecycle event
+ */
+typedef struct
+{
+    uint64_t timestamp;                 /**< Value of the trace clock (0 if no clock is set) */
+    uint32_t sequence;                  /**< Global sequence number of the event */
+    dmosi_process_id_t pid;             /**< ID of the process concerned */
+    int32_t arg;                        /**< Event specific argument */
+    uint8_t event;                      /**< One of dmosi_process_trace_event_t */
+} dmosi_process_trace_record_t;
+
+/**
+ * @brief Time source for trace timestamps
+ */
+typedef uint64_t (*dmosi_process_trace_clock_t)( void );
+
+/**
+ * @brief Set the time source used to timestamp trace records
+ *
+ * @param clock Time source (NULL = no timestamps)
+ */
+void dmosi_process_trace_set_clock( dmosi_process_trace_clock_t clock );
+
+/**
+ * @brief Copy the recorded events, oldest first
+ *
+ * Recording is enabled by building with a non-zero DMOSI_PROC_TRACE_SIZE;
+ * otherwise nothing is recorded and this returns 0.
+ *
+ * @param records Buffer for the records
+ * @param max_count Capacity of the buffer
+ * @return size_t Number of records written
+ */
+size_t dmosi_process_trace_read( dmosi_process_trace_record_t* records, size_t max_count );
+
+/**
+ * @brief Format and log all recorded events, oldest first
+ */
+void dmosi_process_trace_dump( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DMOSI_PROC_H
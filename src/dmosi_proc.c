@@ -1,11 +1,185 @@
 #include "dmosi.h"
+#include "dmosi_proc.h"
 #include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <assert.h>
 
 // DMOSPROC in ASCII
 #define MAGIC_NUMBER    0x444D4F5350524F43ULL    
 
-static dmosi_process_id_t next_process_id = 1; 
+// Initial number of slots in a process index (must be a power of two)
+#define INDEX_INITIAL_CAPACITY      16
+
+// Number of statically allocated process slots (0 = allocate processes from the heap)
+#ifndef DMOSI_PROC_POOL_SIZE
+#   define DMOSI_PROC_POOL_SIZE         0
+#endif
+
+// Size of the inline name buffer of a pooled process (longer names go to the heap)
+#ifndef DMOSI_PROC_POOL_NAME_LENGTH
+#   define DMOSI_PROC_POOL_NAME_LENGTH  32
+#endif
+
+// Size of the inline working directory buffer of a pooled process (longer paths go to the heap)
+#ifndef DMOSI_PROC_POOL_PWD_LENGTH
+#   define DMOSI_PROC_POOL_PWD_LENGTH   64
+#endif
+
+// Number of thread handles fetched at once while killing the threads of a process
+#ifndef DMOSI_PROC_KILL_BATCH_SIZE
+#   define DMOSI_PROC_KILL_BATCH_SIZE   16
+#endif
+#define KILL_BATCH_SIZE             DMOSI_PROC_KILL_BATCH_SIZE
+
+// Number of records in the lifecycle trace ring (0 = tracing disabled, otherwise a power of two)
+#ifndef DMOSI_PROC_TRACE_SIZE
+#   define DMOSI_PROC_TRACE_SIZE        0
+#endif
+
+// Strip logging and validation from the getters (1 = fast build, 0 = checked build)
+#ifndef DMOSI_PROC_FAST_ACCESSORS
+#   define DMOSI_PROC_FAST_ACCESSORS    0
+#endif
+
+// Highest process ID handed out by the allocator (bounds the PID bitmap)
+#ifndef DMOSI_PROC_PID_MAX
+#   define DMOSI_PROC_PID_MAX           32767
+#endif
+
+// Number of PIDs tracked by each word of the PID bitmap
+#define PID_WORD_BITS               32
+
+// Initial number of words in the PID bitmap
+#define PID_BITMAP_INITIAL_WORDS    4
+
+// Number of handle slots allocated at once; the handle table covers PIDs up to DMOSI_PROC_PID_MAX
+#define HANDLE_CHUNK_SIZE           128
+#define HANDLE_CHUNK_COUNT          (DMOSI_PROC_PID_MAX / HANDLE_CHUNK_SIZE + 1)
+
+// Number of processes the reaper thread destroys between checks for new work
+#ifndef DMOSI_PROC_REAP_BATCH_SIZE
+#   define DMOSI_PROC_REAP_BATCH_SIZE   8
+#endif
+
+// Maximum count of the per-process termination semaphore
+#define DONE_SEMAPHORE_MAX_COUNT    0xFFFF
+
+// Poll interval used by wait when no termination semaphore is available
+#define WAIT_POLL_INTERVAL_MS       100
+
+/**
+ * @brief Check the process handle at the start of a getter
+ *
+ * The checked build logs the error and returns @p retval from the getter.
+ * The fast build reduces the getter to a plain field read and only keeps
+ * a debug assertion.
+ */
+#if DMOSI_PROC_FAST_ACCESSORS
+#   define GETTER_CHECK(condition, retval, ...)     assert(condition)
+#else
+#   define GETTER_CHECK(condition, retval, ...)             \
+        do {                                                \
+            if(!(condition))                                \
+            {                                               \
+                DMOD_LOG_ERROR(__VA_ARGS__);                \
+                return retval;                              \
+            }                                               \
+        } while(0)
+#endif
+
+/**
+ * @brief Open-addressing hash table of process handles
+ *
+ * The key of each process is derived from the process itself by the
+ * index's hash function, so the same structure serves the PID registry
+ * and the name index.
+ */
+typedef struct
+{
+    dmosi_process_t* slots;                         /**< Table of process handles (NULL = empty) */
+    size_t capacity;                                /**< Number of slots (power of two) */
+    size_t count;                                   /**< Number of processes in the index */
+    size_t (*hash)(dmosi_process_t process);        /**< Computes the key hash of a process */
+} process_index_t;
+
+/**
+ * @brief Bitmap of process IDs in use
+ *
+ * Bit N is set while PID N belongs to a process. PID 0 is never handed
+ * out. The bitmap grows on demand up to DMOSI_PROC_PID_MAX, and freed
+ * PIDs are reused lowest first, which keeps the PID range dense.
+ */
+static uint32_t* pid_bitmap = NULL;
+static size_t pid_bitmap_words = 0;
+static size_t pid_first_free = 1;                   /**< No PID below this one is free */
+
+/**
+ * @brief Interned module name shared by all processes of a module
+ *
+ * Entries count the processes that use them but are never freed, so a
+ * module keeps its handle across respawns and create/destroy cycles do
+ * not allocate once the module name is known. The table grows with the
+ * number of distinct module names only.
+ */
+typedef struct module_entry
+{
+    const char* name;                               /**< Module name (points to the storage following the entry) */
+    struct module_entry* next;                      /**< Next entry of the module table */
+    size_t refs;                                    /**< Number of processes of the module */
+    uint32_t hash;                                  /**< Hash of the module name */
+    dmosi_process_module_t id;                      /**< Handle of the module */
+} module_entry_t;
+
+static module_entry_t* module_table = NULL;
+
+// Set once the thread layer attaches threads, processes then track their own threads
+static _Atomic bool thread_registry_active = false;
+
+// Applies process scheduling attributes to threads (installed by the thread layer)
+static dmosi_process_sched_handler_t sched_handler = NULL;
+
+static struct dmosi_process* _Atomic reap_queue = NULL;    /**< Lock-free stack of processes to destroy */
+static dmosi_semaphore_t reaper_wakeup = NULL;              /**< Posted when processes are queued (NULL = no reaper thread) */
+static dmosi_process_module_t next_module_id = 1;
+
+/**
+ * @brief Shared state of a dmosi_process_wait_any / _wait_all call
+ */
+typedef struct
+{
+    dmosi_semaphore_t wakeup;                       /**< Posted once when pending drops to zero (NULL = poll) */
+    size_t pending;                                 /**< Terminations still needed to wake the waiter */
+} wait_set_t;
+
+/**
+ * @brief Registration of a wait set with one of the processes it watches
+ *
+ * Destroy detaches the nodes of a process once they have fired, so the
+ * waiter only relies on the node for the outcome.
+ */
+typedef struct wait_node
+{
+    wait_set_t* set;                                /**< Wait set the node belongs to */
+    dmosi_process_t process;                        /**< Watched process (NULL = not registered or detached) */
+    struct wait_node* next;                         /**< Next node watching the same process */
+    bool fired;                                     /**< The process has terminated since registration */
+    int exit_status;                                /**< Exit status recorded when the node fired */
+} wait_node_t;
+
+/**
+ * @brief Registered termination callback of a process
+ */
+typedef struct exit_callback
+{
+    dmosi_process_exit_callback_t callback;         /**< Function to call */
+    void* context;                                  /**< User context of the callback */
+    dmosi_process_t process;                        /**< Process the callback watches */
+    int exit_status;                                /**< Exit status recorded when the callback was taken */
+    struct exit_callback* next;                     /**< Next callback of the same process or of the fired list */
+} exit_callback_t;
 
 /**
  * @brief Opaque type for process
@@ -14,20 +188,359 @@ static dmosi_process_id_t next_process_id = 1;
  *
  * @note The actual implementation of the process is hidden
  * from the user and is specific to the underlying OS.
+ *
+ * @note Fields read by the getters, lookups and registry scans come first
+ * so that they share the first cache line on 64-bit targets.
  */
 struct dmosi_process
 {
     uint64_t magic;                                 /**< Magic number for validation */
-    char* name;                                     /**< Name of the process */
-    dmosi_process_t parent;                         /**< Parent process (NULL for detached processes) */
-    char module_name[DMOD_MAX_MODULE_NAME_LENGTH];  /**< Name of the associated module */
-    int exit_status;                                /**< Exit status code (set when process is killed) */
-    dmosi_process_state_t state;                    /**< Current state of the process */
+    _Atomic dmosi_process_state_t state;            /**< Current state of the process */
+    _Atomic int exit_status;                        /**< Exit status code (set when process is killed) */
     dmosi_process_id_t pid;                         /**< Unique process ID */
     dmosi_user_id_t uid;                            /**< User ID associated with the process */
-    char* pwd;                                      /**< Working directory path */
+    dmosi_process_t parent;                         /**< Parent process (NULL for detached processes) */
+    char* name;                                     /**< Name of the process (immutable until destroy) */
+    module_entry_t* module;                         /**< Interned name of the associated module */
+    uint32_t name_hash;                             /**< Cached hash of the process name */
+    uint32_t waiters;                               /**< Number of threads blocked in wait */
+    char* _Atomic pwd;                              /**< Working directory path (published atomically) */
+
+    dmosi_process_t first_child;                    /**< Most recently created child */
+    dmosi_process_t prev_sibling;                   /**< Previous child of the same parent */
+    dmosi_process_t next_sibling;                   /**< Next child of the same parent */
+    char* retired_pwd;                              /**< Previous working directory, kept alive for one more update */
+    dmosi_semaphore_t done;                         /**< Posted once per waiter on termination (created on first wait) */
+    wait_node_t* watchers;                          /**< Wait sets watching the process */
+    exit_callback_t* exit_callbacks;                /**< Callbacks to fire on termination */
+    dmosi_process_thread_link_t* threads;           /**< Threads attached through dmosi_process_attach_thread */
+    size_t thread_count;                            /**< Number of attached threads */
+    dmosi_process_id_t group;                       /**< Process group (PID of the group leader) */
+    int priority;                                   /**< Priority class of the threads (DMOSI_PROCESS_PRIORITY_UNSET = none) */
+    uint32_t affinity;                              /**< CPU mask of the threads (DMOSI_PROCESS_AFFINITY_ANY = none) */
+    struct dmosi_process* reap_next;                /**< Next process in the reaper queue */
+    _Atomic bool reap_queued;                       /**< The process is in the reaper queue */
+    bool auto_reap;                                 /**< Queue the process for the reaper when it terminates */
+    bool dying;                                     /**< Destroy has started, the process no longer accepts children or threads */
+    struct process_batch* batch;                    /**< Block shared with processes created in the same batch */
+    _Atomic size_t allocated_bytes;                 /**< Bytes currently allocated on behalf of the process */
+    _Atomic size_t peak_bytes;                      /**< Highest value of allocated_bytes */
+    _Atomic size_t memory_limit;                    /**< Quota for allocated_bytes (0 = unlimited) */
+    uint64_t cpu_ticks;                             /**< Accumulated CPU ticks (updated inside the critical section) */
 };
 
+/**
+ * @brief Header of a block of processes created by dmosi_process_create_many
+ *
+ * The block holds the header, the process structures and their names in
+ * a single allocation that is released with the last of its processes.
+ */
+typedef struct process_batch
+{
+    size_t live;                                    /**< Number of processes not yet destroyed */
+    size_t name_size;                               /**< Size of each inline name buffer */
+    struct dmosi_process* processes;                /**< Processes of the batch */
+    char* names;                                    /**< Inline name buffers, name_size bytes each */
+} process_batch_t;
+
+#if DMOSI_PROC_POOL_SIZE > 0
+/**
+ * @brief Statically allocated process with inline string storage
+ */
+typedef struct pool_slot
+{
+    struct dmosi_process process;                   /**< Process (must be the first member) */
+    char name[DMOSI_PROC_POOL_NAME_LENGTH];         /**< Inline storage for the process name */
+    char pwd[2][DMOSI_PROC_POOL_PWD_LENGTH];        /**< Inline storage for the current and retired working directory */
+    struct pool_slot* next_free;                    /**< Next slot in the free list */
+} pool_slot_t;
+
+static pool_slot_t process_pool[DMOSI_PROC_POOL_SIZE];
+static pool_slot_t* pool_free_list = NULL;          /**< Slots returned by destroy */
+static size_t pool_untouched = 0;                   /**< Index of the first slot never handed out */
+
+/**
+ * @brief Get the pool slot of a process
+ *
+ * @return pool_slot_t* Slot of the process or NULL if it was allocated from the heap
+ */
+static inline pool_slot_t* pool_slot_of( dmosi_process_t process )
+{
+    uintptr_t address = (uintptr_t)process;
+    if(address < (uintptr_t)&process_pool[0] || address >= (uintptr_t)&process_pool[DMOSI_PROC_POOL_SIZE])
+        return NULL;
+    return (pool_slot_t*)process;
+}
+#endif
+
+/**
+ * @brief Allocate memory for a process
+ *
+ * Takes a slot from the process pool when it is enabled and falls back
+ * to the heap once the pool is exhausted.
+ *
+ * @param module_name Module to charge heap allocations to
+ * @return dmosi_process_t Uninitialized process or NULL on failure
+ */
+static dmosi_process_t process_alloc( const char* module_name )
+{
+#if DMOSI_PROC_POOL_SIZE > 0
+    pool_slot_t* slot = NULL;
+
+    Dmod_EnterCritical();
+    if(pool_free_list)
+    {
+        slot = pool_free_list;
+        pool_free_list = slot->next_free;
+    }
+    else if(pool_untouched < DMOSI_PROC_POOL_SIZE)
+    {
+        slot = &process_pool[pool_untouched++];
+    }
+    Dmod_ExitCritical();
+
+    if(slot)
+        return &slot->process;
+
+    DMOD_LOG_VERBOSE("Process pool exhausted, allocating process of module %s from the heap\n", module_name);
+#endif
+    return Dmod_MallocEx(sizeof(struct dmosi_process), module_name);
+}
+
+/**
+ * @brief Release memory of a process
+ *
+ * Handles processes from the pool, from a batch block and from the heap.
+ *
+ * @note Must be called inside the critical section
+ */
+static void process_free( dmosi_process_t process )
+{
+    if(process->batch)
+    {
+        if(--process->batch->live == 0)
+        {
+            Dmod_Free(process->batch);
+        }
+        return;
+    }
+#if DMOSI_PROC_POOL_SIZE > 0
+    pool_slot_t* slot = pool_slot_of(process);
+    if(slot)
+    {
+        slot->next_free = pool_free_list;
+        pool_free_list = slot;
+        return;
+    }
+#endif
+    Dmod_Free(process);
+}
+
+/**
+ * @brief Get the inline name buffer of a process
+ *
+ * @return char* Name buffer of the pool slot or batch block, NULL if the process has none
+ */
+static inline char* name_buffer( dmosi_process_t process )
+{
+    if(process->batch)
+    {
+        size_t index = (size_t)(process - process->batch->processes);
+        return process->batch->names + index * process->batch->name_size;
+    }
+#if DMOSI_PROC_POOL_SIZE > 0
+    pool_slot_t* slot = pool_slot_of(process);
+    return slot ? slot->name : NULL;
+#else
+    (void)process;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Get an inline working directory buffer that is not currently published
+ *
+ * @param process Process to get the buffer of
+ * @param current Currently published working directory
+ * @return char* Buffer of DMOSI_PROC_POOL_PWD_LENGTH bytes or NULL if the process has none
+ */
+static inline char* pwd_buffer( dmosi_process_t process, const char* current )
+{
+#if DMOSI_PROC_POOL_SIZE > 0
+    pool_slot_t* slot = pool_slot_of(process);
+    if(!slot)
+        return NULL;
+    return current == slot->pwd[0] ? slot->pwd[1] : slot->pwd[0];
+#else
+    (void)process;
+    (void)current;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Heap working directory string shared by a process and its descendants
+ *
+ * Shared strings are never modified: setting the working directory of a
+ * process replaces its string instead of writing to it.
+ */
+typedef struct
+{
+    _Atomic size_t refs;                            /**< Number of processes referring to the string */
+    char path[];                                    /**< Working directory path */
+} shared_pwd_t;
+
+/**
+ * @brief Get the shared string header of a heap working directory
+ */
+static inline shared_pwd_t* shared_pwd_of( char* pwd )
+{
+    return (shared_pwd_t*)(pwd - offsetof(shared_pwd_t, path));
+}
+
+/**
+ * @brief Check whether a working directory is stored in the inline buffers of a process
+ */
+static inline bool pwd_is_inline( dmosi_process_t process, const char* pwd )
+{
+#if DMOSI_PROC_POOL_SIZE > 0
+    pool_slot_t* slot = pool_slot_of(process);
+    return slot && (pwd == slot->pwd[0] || pwd == slot->pwd[1]);
+#else
+    (void)process;
+    (void)pwd;
+    return false;
+#endif
+}
+
+/**
+ * @brief Allocate a shared working directory string
+ *
+ * @param path Path to copy
+ * @param refs Initial number of references
+ * @return char* Path of the shared string or NULL on allocation failure
+ */
+static char* pwd_alloc( const char* path, size_t refs )
+{
+    size_t length = strlen(path);
+    shared_pwd_t* shared = Dmod_Malloc(sizeof(shared_pwd_t) + length + 1);
+    if(!shared)
+        return NULL;
+    atomic_init(&shared->refs, refs);
+    memcpy(shared->path, path, length + 1);
+    return shared->path;
+}
+
+/**
+ * @brief Store a new working directory of a process
+ *
+ * Uses an inline buffer of the process when the path fits, otherwise a
+ * new shared string.
+ *
+ * @param process Process the working directory is for
+ * @param current Currently published working directory (its buffer is not reused)
+ * @param path Path to store
+ * @return char* Stored path or NULL on allocation failure
+ */
+static char* store_pwd( dmosi_process_t process, const char* current, const char* path )
+{
+    char* buffer = pwd_buffer(process, current);
+    size_t length = strlen(path);
+    if(buffer && length < DMOSI_PROC_POOL_PWD_LENGTH)
+    {
+        // The path may point into the buffer itself (e.g. a suffix of the retired string)
+        memmove(buffer, path, length + 1);
+        return buffer;
+    }
+    return pwd_alloc(path, 1);
+}
+
+/**
+ * @brief Drop a reference to a working directory of a process
+ *
+ * Inline strings need no release; shared strings are freed with their
+ * last reference.
+ */
+static void release_pwd( dmosi_process_t process, char* pwd )
+{
+    if(!pwd || pwd_is_inline(process, pwd))
+        return;
+
+    shared_pwd_t* shared = shared_pwd_of(pwd);
+    if(atomic_fetch_sub_explicit(&shared->refs, 1, memory_order_acq_rel) == 1)
+    {
+        Dmod_Free(shared);
+    }
+}
+
+/**
+ * @brief Get the working directory a new process inherits from its parent
+ *
+ * A shared string of the parent is shared by taking references, so
+ * spawning a child does not copy the path. An inline string of a pooled
+ * parent is copied into the child's inline buffer or into one new
+ * shared string.
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param parent Parent process (may be NULL)
+ * @param child Child process to copy into (NULL if the children have no inline buffers)
+ * @param refs Number of children that inherit the working directory
+ * @param pwd Receives the inherited path (NULL = the parent has none)
+ * @return bool true on success, false on allocation failure
+ */
+static bool inherit_pwd( dmosi_process_t parent, dmosi_process_t child, size_t refs, char** pwd )
+{
+    *pwd = parent ? atomic_load_explicit(&parent->pwd, memory_order_relaxed) : NULL;
+    if(!*pwd)
+        return true;
+
+    if(!pwd_is_inline(parent, *pwd))
+    {
+        atomic_fetch_add_explicit(&shared_pwd_of(*pwd)->refs, refs, memory_order_relaxed);
+        return true;
+    }
+
+    char* buffer = child ? pwd_buffer(child, NULL) : NULL;
+    if(buffer && strlen(*pwd) < DMOSI_PROC_POOL_PWD_LENGTH)
+    {
+        strcpy(buffer, *pwd);
+        *pwd = buffer;
+        return true;
+    }
+    *pwd = pwd_alloc(*pwd, refs);
+    return *pwd != NULL;
+}
+
+/**
+ * @brief Copy a string into an inline buffer, or onto the heap if it does not fit
+ *
+ * @param buffer Inline buffer (may be NULL)
+ * @param size Size of the inline buffer
+ * @param str String to copy
+ * @return char* Copy of the string or NULL on allocation failure
+ */
+static char* store_string( char* buffer, size_t size, const char* str )
+{
+    if(buffer && strlen(str) < size)
+    {
+        strcpy(buffer, str);
+        return buffer;
+    }
+    return Dmod_StrDup(str);
+}
+
+/**
+ * @brief Release a string stored by store_string
+ */
+static void release_string( const char* buffer, char* str )
+{
+    if(str && str != buffer)
+    {
+        Dmod_Free(str);
+    }
+}
+
 /**
  * @brief Validate a process handle
  *
@@ -43,438 +556,3463 @@ static bool validate_process( dmosi_process_t process )
 }
 
 /**
- * @brief Generate a unique process ID
- *
- * @return dmosi_process_id_t Unique process ID
+ * @brief Check whether a PID is marked as used in the PID bitmap
  */
-static dmosi_process_id_t generate_process_id()
+static inline bool pid_is_used( size_t pid )
 {
-    return next_process_id++;
+    return (pid_bitmap[pid / PID_WORD_BITS] >> (pid % PID_WORD_BITS)) & 1u;
 }
 
 /**
- * @brief Kill all threads associated with a process
+ * @brief Mark a range of PIDs as used or free
+ */
+static void pid_mark( size_t first, size_t count, bool used )
+{
+    for(size_t pid = first; pid < first + count; pid++)
+    {
+        uint32_t mask = 1u << (pid % PID_WORD_BITS);
+        if(used)
+            pid_bitmap[pid / PID_WORD_BITS] |= mask;
+        else
+            pid_bitmap[pid / PID_WORD_BITS] &= ~mask;
+    }
+}
+
+/**
+ * @brief Grow the PID bitmap so that it covers a given PID
  *
- * @param process Process handle whose threads to kill
- * @param status Exit status code to pass to threads
- * @return bool true on success, false on failure
+ * @note Must be called inside the critical section
+ *
+ * @param pid PID that must be covered (at most DMOSI_PROC_PID_MAX)
+ * @return bool true on success, false on allocation failure
  */
-static bool kill_threads( dmosi_process_t process, int status )
+static bool pid_bitmap_cover( size_t pid )
 {
-    size_t count = dmosi_thread_get_by_process(process, NULL, 0);
-    if(count == 0)
-        return true; // No threads to kill
+    size_t needed = pid / PID_WORD_BITS + 1;
+    if(needed <= pid_bitmap_words)
+        return true;
 
-    dmosi_thread_t* threads = Dmod_MallocEx(sizeof(dmosi_thread_t) * count, process->module_name);
-    if(!threads)
+    size_t words = pid_bitmap_words ? pid_bitmap_words : PID_BITMAP_INITIAL_WORDS;
+    while(words < needed)
     {
-        DMOD_LOG_ERROR("Failed to allocate memory for thread handles while killing process %s of module %s\n", process->name, process->module_name);
-        return false;
+        words *= 2;
     }
+    size_t max_words = DMOSI_PROC_PID_MAX / PID_WORD_BITS + 1;
+    words = words < max_words ? words : max_words;
 
-    size_t actual_count = dmosi_thread_get_by_process(process, threads, count);
-    if(actual_count != count)
+    uint32_t* bitmap = Dmod_Malloc(words * sizeof(uint32_t));
+    if(!bitmap)
+        return false;
+    memset(bitmap, 0, words * sizeof(uint32_t));
+    if(pid_bitmap)
     {
-        DMOD_LOG_WARN("Thread count mismatch while killing process %s of module %s: expected %zu, got %zu\n", process->name, process->module_name, count, actual_count);
+        memcpy(bitmap, pid_bitmap, pid_bitmap_words * sizeof(uint32_t));
+        Dmod_Free(pid_bitmap);
     }
-
-    for(size_t i = 0; i < actual_count; i++)
+    else
     {
-        if(!dmosi_thread_kill(threads[i], status))
-        {
-            DMOD_LOG_ERROR("Failed to kill thread in process %s of module %s\n", process->name, process->module_name);
-            Dmod_Free(threads);
-            return false;
-        }
+        bitmap[0] = 1u; // PID 0 is reserved
     }
-
-    Dmod_Free(threads);
+    pid_bitmap = bitmap;
+    pid_bitmap_words = words;
     return true;
 }
 
 /**
- * @brief Find a process using a custom predicate function
+ * @brief Entry of the handle table, indexed by PID
  *
- * @param predicate Function that returns true if process matches search criteria
- * @param context Context data passed to the predicate function
- * @param search_description Description of what is being searched for (for logging)
- * @return dmosi_process_t Found process or NULL if not found
+ * The generation is odd while a process is registered under the PID and
+ * is incremented on every registration and removal, so a handle taken
+ * from an older process never matches again.
+ *
+ * The slot also counts the processes whose group is the PID. The PID is
+ * not returned to the allocator while any of them is alive, so a new
+ * process can never take over the ID of an orphaned group.
  */
-static dmosi_process_t find_process_with_predicate(bool (*predicate)(dmosi_process_t process, void* context), void* context, const char* search_description)
+typedef struct
 {
-    DMOD_LOG_VERBOSE("Searching for process: %s\n", search_description);
-    
-    // Get all threads to find processes through them
-    size_t thread_count = dmosi_thread_get_all(NULL, 0);
-    if(thread_count == 0)
-    {
-        return NULL; // No threads, no processes
-    }
-    
-    dmosi_thread_t* threads = Dmod_Malloc(sizeof(dmosi_thread_t) * thread_count);
-    if(!threads)
-    {
-        DMOD_LOG_ERROR("Failed to allocate memory for thread handles while searching for process: %s\n", search_description);
-        return NULL;
-    }
-    
-    size_t actual_count = dmosi_thread_get_all(threads, thread_count);
-    dmosi_process_t found_process = NULL;
-    
-    // Check each thread's process
-    for(size_t i = 0; i < actual_count && !found_process; i++)
+    _Atomic uint32_t generation;                    /**< Generation of the current or last process */
+    struct dmosi_process* _Atomic process;          /**< Registered process (NULL when the PID is free) */
+    size_t group_refs;                              /**< Processes in the group named after the PID (protected by the critical section) */
+} handle_slot_t;
+
+// Chunks are never freed, so lock-free readers can index them at any time
+static handle_slot_t* _Atomic handle_chunks[HANDLE_CHUNK_COUNT];
+
+/**
+ * @brief Allocate the handle table chunks of a PID range
+ *
+ * @note Must be called inside the critical section
+ *
+ * @return bool true on success, false on allocation failure
+ */
+static bool handle_cover( size_t first, size_t last )
+{
+    for(size_t chunk = first / HANDLE_CHUNK_SIZE; chunk <= last / HANDLE_CHUNK_SIZE; chunk++)
     {
-        dmosi_process_t process = dmosi_thread_get_process(threads[i]);
-        if(process && predicate(process, context))
+        if(atomic_load_explicit(&handle_chunks[chunk], memory_order_relaxed))
+            continue;
+
+        handle_slot_t* slots = Dmod_Malloc(sizeof(handle_slot_t) * HANDLE_CHUNK_SIZE);
+        if(!slots)
+            return false;
+        for(size_t i = 0; i < HANDLE_CHUNK_SIZE; i++)
         {
-            found_process = process;
-            break;
+            atomic_init(&slots[i].generation, 0);
+            atomic_init(&slots[i].process, NULL);
+            slots[i].group_refs = 0;
         }
+        atomic_store_explicit(&handle_chunks[chunk], slots, memory_order_release);
     }
-    
-    Dmod_Free(threads);
-    return found_process;
+    return true;
 }
 
 /**
- * @brief Predicate function for finding process by name
+ * @brief Find the handle slot of a PID without locking
+ *
+ * @return handle_slot_t* Slot or NULL if the PID is not covered by the table
  */
-static bool process_name_predicate(dmosi_process_t process, void* context)
+static inline handle_slot_t* handle_slot( dmosi_process_id_t pid )
 {
-    const char* name = (const char*)context;
-    return process->name && strcmp(process->name, name) == 0;
+    if(pid > DMOSI_PROC_PID_MAX)
+        return NULL;
+    handle_slot_t* chunk = atomic_load_explicit(&handle_chunks[pid / HANDLE_CHUNK_SIZE], memory_order_acquire);
+    return chunk ? &chunk[pid % HANDLE_CHUNK_SIZE] : NULL;
 }
 
 /**
- * @brief Predicate function for finding process by ID
+ * @brief Publish a process in the handle table under its PID
+ *
+ * @note Must be called inside the critical section
  */
-static bool process_id_predicate(dmosi_process_t process, void* context)
+static void handle_publish( struct dmosi_process* process, dmosi_process_id_t pid )
 {
-    dmosi_process_id_t* pid = (dmosi_process_id_t*)context;
-    return process->pid == *pid;
+    handle_slot_t* slot = handle_slot(pid);
+    if(!slot)
+        return;
+    atomic_store_explicit(&slot->process, process, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slot->generation, 1, memory_order_release);
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_create,(const char* name, const char* module_name, dmosi_process_t parent) )
+/**
+ * @brief Remove the process registered under a PID from the handle table
+ *
+ * @note Must be called inside the critical section
+ */
+static void handle_retire( dmosi_process_id_t pid )
 {
-    if(name == NULL)
-    {
-        DMOD_LOG_ERROR("Process name cannot be NULL\n");
-        return NULL;
-    }
-    module_name = module_name ? module_name : DMOSI_SYSTEM_MODULE_NAME;
-    dmosi_process_t process = Dmod_MallocEx(sizeof(struct dmosi_process), module_name );
-    if(!process)
+    handle_slot_t* slot = handle_slot(pid);
+    if(!slot)
+        return;
+    atomic_fetch_add_explicit(&slot->generation, 1, memory_order_release);
+    atomic_store_explicit(&slot->process, NULL, memory_order_relaxed);
+}
+
+/**
+ * @brief Allocate a contiguous range of free process IDs
+ *
+ * Returns the lowest free range, so PIDs of destroyed processes are
+ * recycled and the PID range stays as dense as the number of live
+ * processes allows.
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param count Number of consecutive PIDs to allocate
+ * @return dmosi_process_id_t First PID of the range or 0 if no range is available
+ */
+static dmosi_process_id_t pid_alloc( size_t count )
+{
+    size_t start = pid_first_free;
+    size_t pid = start;
+    while(start + count - 1 <= DMOSI_PROC_PID_MAX)
+    {
+        if(!pid_bitmap_cover(start + count - 1))
+            return 0;
+
+        if(pid % PID_WORD_BITS == 0 && pid_bitmap[pid / PID_WORD_BITS] == UINT32_MAX)
+        {
+            // Skip fully used words
+            pid += PID_WORD_BITS;
+            start = pid;
+            continue;
+        }
+        if(pid_is_used(pid))
+        {
+            start = ++pid;
+            continue;
+        }
+        if(++pid - start == count)
+        {
+            if(!handle_cover(start, start + count - 1))
+                return 0;
+            pid_mark(start, count, true);
+            if(start == pid_first_free)
+            {
+                pid_first_free = start + count;
+            }
+            return (dmosi_process_id_t)start;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Mark a process ID as used by a process that chose it explicitly
+ *
+ * PIDs above DMOSI_PROC_PID_MAX are never handed out by the allocator and
+ * therefore need no tracking.
+ *
+ * @note Must be called inside the critical section
+ *
+ * @return bool true on success, false on allocation failure
+ */
+static bool pid_claim( dmosi_process_id_t pid )
+{
+    if(pid > DMOSI_PROC_PID_MAX)
+        return true;
+    if(!pid_bitmap_cover(pid) || !handle_cover(pid, pid))
+        return false;
+    pid_mark(pid, 1, true);
+    return true;
+}
+
+/**
+ * @brief Mark a process ID as free in the allocator
+ *
+ * @note Must be called inside the critical section
+ */
+static void pid_free( dmosi_process_id_t pid )
+{
+    if(pid == 0 || pid / PID_WORD_BITS >= pid_bitmap_words)
+        return;
+    pid_mark(pid, 1, false);
+    if(pid < pid_first_free)
+    {
+        pid_first_free = pid;
+    }
+}
+
+/**
+ * @brief Check whether live processes still belong to the group named after a PID
+ *
+ * @note Must be called inside the critical section
+ */
+static bool pid_names_group( dmosi_process_id_t pid )
+{
+    handle_slot_t* slot = handle_slot(pid);
+    return slot && slot->group_refs > 0;
+}
+
+/**
+ * @brief Return a process ID to the allocator
+ *
+ * A PID that still names a group stays allocated until the last member
+ * of the group leaves it (see group_release).
+ *
+ * @note Must be called inside the critical section
+ */
+static void pid_release( dmosi_process_id_t pid )
+{
+    if(!pid_names_group(pid))
+    {
+        pid_free(pid);
+    }
+}
+
+/**
+ * @brief Count a process as a member of a group
+ *
+ * @note Must be called inside the critical section
+ */
+static void group_acquire( dmosi_process_id_t group )
+{
+    handle_slot_t* slot = handle_slot(group);
+    if(slot)
+    {
+        slot->group_refs++;
+    }
+}
+
+/**
+ * @brief Remove a process from the member count of a group
+ *
+ * Frees the PID of the group once the last member has left and the
+ * leader is gone.
+ *
+ * @note Must be called inside the critical section
+ */
+static void group_release( dmosi_process_id_t group )
+{
+    handle_slot_t* slot = handle_slot(group);
+    if(slot && slot->group_refs > 0 && --slot->group_refs == 0
+     && atomic_load_explicit(&slot->process, memory_order_relaxed) == NULL)
+    {
+        pid_free(group);
+    }
+}
+
+/**
+ * @brief Compute the index hash of a process ID
+ */
+static inline size_t pid_hash( dmosi_process_id_t pid )
+{
+    return (size_t)((uint32_t)pid * 2654435761u);
+}
+
+/**
+ * @brief Compute the hash of a process name (FNV-1a)
+ */
+static uint32_t name_hash( const char* name )
+{
+    uint32_t hash = 2166136261u;
+    while(*name)
+    {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static size_t process_pid_hash( dmosi_process_t process )
+{
+    return pid_hash(process->pid);
+}
+
+static size_t process_name_hash( dmosi_process_t process )
+{
+    return process->name_hash;
+}
+
+/**
+ * @brief Find the interned entry of a module name
+ *
+ * @note Must be called inside the critical section
+ *
+ * @return module_entry_t* Entry of the module or NULL if it is not interned
+ */
+static module_entry_t* module_lookup( const char* module_name, uint32_t hash )
+{
+    for(module_entry_t* entry = module_table; entry; entry = entry->next)
+    {
+        if(entry->hash == hash && strcmp(entry->name, module_name) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get the interned entry of a module name, adding it if needed
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param module_name Name of the module
+ * @param refs Number of references taken on the entry
+ * @return module_entry_t* Entry of the module or NULL on allocation failure
+ */
+static module_entry_t* module_acquire( const char* module_name, size_t refs )
+{
+    uint32_t hash = name_hash(module_name);
+    module_entry_t* entry = module_lookup(module_name, hash);
+    if(entry)
+    {
+        entry->refs += refs;
+        return entry;
+    }
+
+    size_t length = strlen(module_name);
+    entry = Dmod_Malloc(sizeof(module_entry_t) + length + 1);
+    if(!entry)
+        return NULL;
+    memcpy(entry + 1, module_name, length + 1);
+    entry->name = (const char*)(entry + 1);
+    entry->hash = hash;
+    entry->refs = refs;
+    entry->id = next_module_id++;
+    if(next_module_id == DMOSI_PROCESS_MODULE_INVALID)
+    {
+        next_module_id = 1;
+    }
+    entry->next = module_table;
+    module_table = entry;
+    return entry;
+}
+
+/**
+ * @brief Find the interned entry of a module handle
+ *
+ * @note Must be called inside the critical section
+ *
+ * @return module_entry_t* Entry of the module or NULL if the handle is unknown
+ */
+static module_entry_t* module_by_id( dmosi_process_module_t id )
+{
+    for(module_entry_t* entry = module_table; entry; entry = entry->next)
+    {
+        if(entry->id == id)
+            return entry;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Drop references to an interned module name
+ *
+ * The entry stays interned when the last reference is dropped.
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param entry Entry of the module (may be NULL)
+ * @param refs Number of references to drop
+ */
+static void module_release( module_entry_t* entry, size_t refs )
+{
+    if(!entry)
+        return;
+    entry->refs -= refs;
+}
+
+static process_index_t pid_index  = { .hash = process_pid_hash };   /**< Registry of processes keyed by PID */
+static process_index_t name_index = { .hash = process_name_hash };  /**< Index of processes keyed by name */
+
+/**
+ * @brief Rebuild an index with the given number of slots
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param index Index to rebuild
+ * @param capacity New number of slots (must be a power of two)
+ * @return bool true on success, false on allocation failure
+ */
+static bool index_rehash( process_index_t* index, size_t capacity )
+{
+    dmosi_process_t* slots = Dmod_Malloc(sizeof(dmosi_process_t) * capacity);
+    if(!slots)
+    {
+        DMOD_LOG_ERROR("Failed to allocate process index with %zu slots\n", capacity);
+        return false;
+    }
+    memset(slots, 0, sizeof(dmosi_process_t) * capacity);
+
+    for(size_t i = 0; i < index->capacity; i++)
+    {
+        dmosi_process_t process = index->slots[i];
+        if(process == NULL)
+            continue;
+
+        size_t slot = index->hash(process) & (capacity - 1);
+        while(slots[slot] != NULL)
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        slots[slot] = process;
+    }
+
+    Dmod_Free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Make sure an index has room for more processes
+ *
+ * After a successful reservation the next @p count insertions cannot fail.
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param index Index to check
+ * @param count Number of processes about to be inserted
+ * @return bool true on success, false on allocation failure
+ */
+static bool index_reserve( process_index_t* index, size_t count )
+{
+    if((index->count + count) * 2 <= index->capacity)
+        return true;
+
+    size_t capacity = index->capacity ? index->capacity * 2 : INDEX_INITIAL_CAPACITY;
+    while((index->count + count) * 2 > capacity)
+    {
+        capacity *= 2;
+    }
+    return index_rehash(index, capacity);
+}
+
+/**
+ * @brief Add a process to an index under its current key
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param index Index to add the process to
+ * @param process Process to add
+ * @return bool true on success, false on allocation failure
+ */
+static bool index_insert( process_index_t* index, dmosi_process_t process )
+{
+    if(!index_reserve(index, 1))
+        return false;
+
+    size_t slot = index->hash(process) & (index->capacity - 1);
+    while(index->slots[slot] != NULL)
+    {
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+    index->slots[slot] = process;
+    index->count++;
+    return true;
+}
+
+/**
+ * @brief Remove a process from an index
+ *
+ * The process is looked up by its current key, so this must be called
+ * before the key of an indexed process is changed. Entries following the
+ * removed one are shifted back into place, so the index never accumulates
+ * tombstones and never has to be rebuilt because of churn.
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param index Index to remove the process from
+ * @param process Process to remove
+ */
+static void index_remove( process_index_t* index, dmosi_process_t process )
+{
+    if(index->capacity == 0)
+        return;
+
+    size_t mask = index->capacity - 1;
+    size_t hole = index->hash(process) & mask;
+    while(index->slots[hole] != process)
+    {
+        if(index->slots[hole] == NULL)
+            return;
+        hole = (hole + 1) & mask;
+    }
+    index->slots[hole] = NULL;
+    index->count--;
+
+    for(size_t slot = (hole + 1) & mask; index->slots[slot] != NULL; slot = (slot + 1) & mask)
+    {
+        size_t home = index->hash(index->slots[slot]) & mask;
+        bool reachable = hole <= slot ? (hole < home && home <= slot)
+                                      : (hole < home || home <= slot);
+        if(reachable)
+            continue;   // Still reachable from its home slot without crossing the hole
+
+        index->slots[hole] = index->slots[slot];
+        index->slots[slot] = NULL;
+        hole = slot;
+    }
+}
+
+/**
+ * @brief Look up a registered process by its PID
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param pid Process ID to look for
+ * @return dmosi_process_t Found process or NULL if not found
+ */
+static dmosi_process_t find_by_pid( dmosi_process_id_t pid )
+{
+    if(pid_index.capacity == 0)
+        return NULL;
+
+    size_t mask = pid_index.capacity - 1;
+    for(size_t slot = pid_hash(pid) & mask; pid_index.slots[slot] != NULL; slot = (slot + 1) & mask)
+    {
+        dmosi_process_t process = pid_index.slots[slot];
+        if(process->pid == pid)
+            return process;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Look up a registered process by its name
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param name Process name to look for
+ * @return dmosi_process_t Found process or NULL if not found
+ */
+static dmosi_process_t find_by_name( const char* name )
+{
+    if(name_index.capacity == 0)
+        return NULL;
+
+    uint32_t hash = name_hash(name);
+    size_t mask = name_index.capacity - 1;
+    for(size_t slot = hash & mask; name_index.slots[slot] != NULL; slot = (slot + 1) & mask)
+    {
+        dmosi_process_t process = name_index.slots[slot];
+        if(process->name_hash == hash && strcmp(process->name, name) == 0)
+            return process;
+    }
+    return NULL;
+}
+
+#if DMOSI_PROC_TRACE_SIZE > 0
+#if (DMOSI_PROC_TRACE_SIZE & (DMOSI_PROC_TRACE_SIZE - 1)) != 0
+#   error "DMOSI_PROC_TRACE_SIZE must be a power of two"
+#endif
+/**
+ * @brief Slot of the trace ring
+ */
+typedef struct
+{
+    _Atomic uint32_t commit;                        /**< Sequence number + 1 once the record is complete, 0 while written */
+    dmosi_process_trace_record_t record;            /**< Recorded event */
+} trace_slot_t;
+
+static trace_slot_t trace_ring[DMOSI_PROC_TRACE_SIZE];
+static _Atomic uint32_t trace_head = 0;             /**< Sequence number of the next record */
+static dmosi_process_trace_clock_t trace_clock = NULL;
+#endif
+
+/**
+ * @brief Record a lifecycle event in the trace ring
+ *
+ * Lock-free: writers claim a slot with a single fetch-add and publish it
+ * with a release store, so this is safe from any context.
+ *
+ * @param event Event type
+ * @param pid ID of the process concerned
+ * @param arg Event specific argument (status, timeout, result)
+ */
+static inline void trace_event( dmosi_process_trace_event_t event, dmosi_process_id_t pid, int32_t arg )
+{
+#if DMOSI_PROC_TRACE_SIZE > 0
+    uint32_t sequence = atomic_fetch_add_explicit(&trace_head, 1, memory_order_relaxed);
+    trace_slot_t* slot = &trace_ring[sequence & (DMOSI_PROC_TRACE_SIZE - 1)];
+    dmosi_process_trace_clock_t clock = trace_clock;
+
+    atomic_store_explicit(&slot->commit, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->record.timestamp = clock ? clock() : 0;
+    slot->record.sequence = sequence;
+    slot->record.pid = pid;
+    slot->record.arg = arg;
+    slot->record.event = event;
+    atomic_store_explicit(&slot->commit, sequence + 1, memory_order_release);
+#else
+    (void)event;
+    (void)pid;
+    (void)arg;
+#endif
+}
+
+/**
+ * @brief Read the state of a process without taking the critical section
+ */
+static inline dmosi_process_state_t load_state( dmosi_process_t process )
+{
+    return atomic_load_explicit(&process->state, memory_order_acquire);
+}
+
+/**
+ * @brief Read the exit status of a process without taking the critical section
+ */
+static inline int load_exit_status( dmosi_process_t process )
+{
+    return atomic_load_explicit(&process->exit_status, memory_order_relaxed);
+}
+
+/**
+ * @brief Mark a process as terminated with the given exit status
+ *
+ * The exit status is published before the state, so a reader that sees
+ * the TERMINATED state also sees the final exit status.
+ */
+static inline void store_terminated( dmosi_process_t process, int exit_status )
+{
+    atomic_store_explicit(&process->exit_status, exit_status, memory_order_relaxed);
+    atomic_store_explicit(&process->state, DMOSI_PROCESS_STATE_TERMINATED, memory_order_release);
+}
+
+/**
+ * @brief Get a parent that can still accept children
+ *
+ * A process that is being destroyed has already detached its children,
+ * so a child linked to it afterwards would keep a dangling parent.
+ *
+ * @note Must be called inside the critical section
+ *
+ * @return dmosi_process_t The parent or NULL if it is invalid or being destroyed
+ */
+static dmosi_process_t live_parent( dmosi_process_t parent )
+{
+    return validate_process(parent) && !parent->dying ? parent : NULL;
+}
+
+/**
+ * @brief Link a process into the child list of its parent
+ *
+ * @note Must be called inside the critical section
+ */
+static void link_child( dmosi_process_t process )
+{
+    dmosi_process_t parent = process->parent;
+    process->prev_sibling = NULL;
+    process->next_sibling = parent->first_child;
+    if(parent->first_child)
+    {
+        parent->first_child->prev_sibling = process;
+    }
+    parent->first_child = process;
+}
+
+/**
+ * @brief Unlink a process from its parent and detach its children
+ *
+ * @note Must be called inside the critical section
+ */
+static void unlink_process( dmosi_process_t process )
+{
+    if(process->parent)
+    {
+        if(process->prev_sibling)
+        {
+            process->prev_sibling->next_sibling = process->next_sibling;
+        }
+        else if(process->parent->first_child == process)
+        {
+            process->parent->first_child = process->next_sibling;
+        }
+        if(process->next_sibling)
+        {
+            process->next_sibling->prev_sibling = process->prev_sibling;
+        }
+    }
+
+    dmosi_process_t child = process->first_child;
+    while(child)
+    {
+        dmosi_process_t next = child->next_sibling;
+        child->parent = NULL;
+        child->prev_sibling = NULL;
+        child->next_sibling = NULL;
+        child = next;
+    }
+
+    process->parent = NULL;
+    process->first_child = NULL;
+    process->prev_sibling = NULL;
+    process->next_sibling = NULL;
+}
+
+/**
+ * @brief Wake up every thread blocked in wait on a process
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param process Process that has just terminated
+ */
+static void signal_waiters( dmosi_process_t process )
+{
+    for(wait_node_t* node = process->watchers; node; node = node->next)
+    {
+        if(node->fired)
+            continue;
+        node->fired = true;
+        node->exit_status = load_exit_status(process);
+        if(node->set->pending > 0 && --node->set->pending == 0 && node->set->wakeup)
+        {
+            dmosi_semaphore_post(node->set->wakeup);
+        }
+    }
+
+    if(!process->done)
+        return;
+
+    for(uint32_t i = 0; i < process->waiters; i++)
+    {
+        dmosi_semaphore_post(process->done);
+    }
+}
+
+/**
+ * @brief Move the termination callbacks of a process onto a list of callbacks to fire
+ *
+ * @note Must be called inside the critical section after store_terminated
+ *
+ * @param process Process that has just terminated
+ * @param fired List the callbacks are prepended to
+ */
+static void take_exit_callbacks( dmosi_process_t process, exit_callback_t** fired )
+{
+    while(process->exit_callbacks)
+    {
+        exit_callback_t* entry = process->exit_callbacks;
+        process->exit_callbacks = entry->next;
+        entry->exit_status = load_exit_status(process);
+        entry->next = *fired;
+        *fired = entry;
+    }
+}
+
+/**
+ * @brief Invoke and release a list of callbacks taken by take_exit_callbacks
+ *
+ * @note Must be called outside the critical section
+ */
+static void run_exit_callbacks( exit_callback_t* fired )
+{
+    while(fired)
+    {
+        exit_callback_t* entry = fired;
+        fired = entry->next;
+        entry->callback(entry->process, entry->exit_status, entry->context);
+        Dmod_Free(entry);
+    }
+}
+
+/**
+ * @brief Detach every wait set from a process that is being destroyed
+ *
+ * @note Must be called inside the critical section after signal_waiters
+ */
+static void detach_watchers( dmosi_process_t process )
+{
+    for(wait_node_t* node = process->watchers; node; node = node->next)
+    {
+        node->process = NULL;
+    }
+    process->watchers = NULL;
+}
+
+/**
+ * @brief Wait for a process to terminate by polling its state
+ *
+ * Fallback for targets where the termination semaphore cannot be created.
+ *
+ * @param process Process to wait for
+ * @param timeout_ms Timeout in milliseconds (negative = infinite)
+ * @return int 0 on termination, -ETIMEDOUT on timeout
+ */
+static int poll_for_termination( dmosi_process_t process, int32_t timeout_ms )
+{
+    int32_t elapsed = 0;
+
+    while(load_state(process) != DMOSI_PROCESS_STATE_TERMINATED)
+    {
+        if(timeout_ms >= 0 && elapsed >= timeout_ms)
+        {
+            DMOD_LOG_WARN("Timeout while waiting for process %s of module %s to terminate\n", process->name, process->module->name);
+            return -ETIMEDOUT;
+        }
+        dmosi_thread_sleep(WAIT_POLL_INTERVAL_MS);
+        elapsed += WAIT_POLL_INTERVAL_MS;
+    }
+    return 0;
+}
+
+/**
+ * @brief Initialize the fields of a newly allocated process
+ *
+ * @param process Process to initialize (its batch field must already be set)
+ * @param name Stored copy of the process name
+ * @param parent Parent process (ignored if not a valid handle)
+ * @param pid Process ID to assign
+ */
+static void init_process( dmosi_process_t process, char* name, dmosi_process_t parent, dmosi_process_id_t pid )
+{
+    process->magic = MAGIC_NUMBER;
+    atomic_init(&process->exit_status, 0);
+    atomic_init(&process->state, DMOSI_PROCESS_STATE_RUNNING);
+    process->name = name;
+    process->name_hash = name_hash(name);
+    process->pid = pid;
+    process->uid = 0;
+    atomic_init(&process->pwd, NULL);
+    process->retired_pwd = NULL;
+    atomic_init(&process->allocated_bytes, 0);
+    atomic_init(&process->peak_bytes, 0);
+    atomic_init(&process->memory_limit, 0);
+    process->cpu_ticks = 0;
+    process->done = NULL;
+    process->waiters = 0;
+    process->watchers = NULL;
+    process->exit_callbacks = NULL;
+    process->threads = NULL;
+    process->thread_count = 0;
+    process->parent = validate_process(parent) ? parent : NULL;
+    process->first_child = NULL;
+    process->prev_sibling = NULL;
+    process->next_sibling = NULL;
+    process->module = NULL;
+    process->group = 0;
+    process->reap_next = NULL;
+    atomic_init(&process->reap_queued, false);
+    process->auto_reap = false;
+    process->dying = false;
+    process->priority = DMOSI_PROCESS_PRIORITY_UNSET;
+    process->affinity = DMOSI_PROCESS_AFFINITY_ANY;
+}
+
+/**
+ * @brief Copy the attributes a new process inherits from its parent
+ *
+ * @note Must be called inside the critical section, after the parent has
+ * been checked with live_parent, so that the attributes cannot change
+ * or come from a rejected parent meanwhile
+ *
+ * @param process New process (its parent field may be NULL)
+ */
+static void inherit_attributes( dmosi_process_t process )
+{
+    dmosi_process_t parent = process->parent;
+    if(!parent)
+        return;
+    process->auto_reap = parent->auto_reap;
+    process->priority = parent->priority;
+    process->affinity = parent->affinity;
+}
+
+/**
+ * @brief Write a decimal number into a buffer
+ *
+ * @param buffer Destination (must be large enough, no terminator is added)
+ * @param value Number to write
+ * @return size_t Number of characters written
+ */
+static size_t format_decimal( char* buffer, size_t value )
+{
+    char digits[20];
+    size_t length = 0;
+    do
+    {
+        digits[length++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value > 0);
+
+    for(size_t i = 0; i < length; i++)
+    {
+        buffer[i] = digits[length - 1 - i];
+    }
+    return length;
+}
+
+/**
+ * @brief Add an initialized process to the indexes and to its parent
+ *
+ * @note Must be called inside the critical section after room has been
+ * reserved in both indexes
+ */
+static void register_process( dmosi_process_t process )
+{
+    index_insert(&pid_index, process);
+    handle_publish(process, process->pid);
+    group_acquire(process->group);
+    index_insert(&name_index, process);
+    if(process->parent)
+    {
+        link_child(process);
+    }
+}
+
+/**
+ * @brief Block until a process terminates
+ *
+ * @param process Process to wait for
+ * @param timeout_ms Timeout in milliseconds (negative = infinite)
+ * @return int 0 on termination, -ETIMEDOUT on timeout
+ */
+static int wait_for_termination( dmosi_process_t process, int32_t timeout_ms )
+{
+    Dmod_EnterCritical();
+    if(load_state(process) == DMOSI_PROCESS_STATE_TERMINATED)
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_VERBOSE("Process %s of module %s has terminated with exit status %d\n", process->name, process->module->name, load_exit_status(process));
+        return 0;
+    }
+    if(timeout_ms == 0)
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_WARN("Timeout while waiting for process %s of module %s to terminate\n", process->name, process->module->name);
+        return -ETIMEDOUT;
+    }
+    if(!process->done)
+    {
+        process->done = dmosi_semaphore_create(0, DONE_SEMAPHORE_MAX_COUNT);
+    }
+    if(!process->done)
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_VERBOSE("No termination semaphore for process %s of module %s, polling instead\n", process->name, process->module->name);
+        return poll_for_termination(process, timeout_ms);
+    }
+    dmosi_semaphore_t done = process->done;
+    process->waiters++;
+    Dmod_ExitCritical();
+
+    // kill and destroy post the semaphore once per waiter on termination
+    dmosi_semaphore_wait(done, timeout_ms);
+
+    Dmod_EnterCritical();
+    bool terminated = load_state(process) == DMOSI_PROCESS_STATE_TERMINATED;
+    if(terminated)
+    {
+        DMOD_LOG_VERBOSE("Process %s of module %s has terminated with exit status %d\n", process->name, process->module->name, load_exit_status(process));
+    }
+    else
+    {
+        DMOD_LOG_WARN("Timeout while waiting for process %s of module %s to terminate\n", process->name, process->module->name);
+    }
+    // The process may be freed by destroy as soon as the last waiter leaves
+    process->waiters--;
+    Dmod_ExitCritical();
+
+    return terminated ? 0 : -ETIMEDOUT;
+}
+
+/**
+ * @brief Register a wait set with a process
+ *
+ * @note Must be called inside the critical section
+ */
+static void watch_process( wait_node_t* node, wait_set_t* set, dmosi_process_t process )
+{
+    node->set = set;
+    node->process = process;
+    node->fired = false;
+    node->next = process->watchers;
+    process->watchers = node;
+}
+
+/**
+ * @brief Unregister a wait set from the process it watches
+ *
+ * @note Must be called inside the critical section
+ */
+static void unwatch_process( wait_node_t* node )
+{
+    if(!node->process)
+        return;
+
+    wait_node_t** link = &node->process->watchers;
+    while(*link != node)
+    {
+        link = &(*link)->next;
+    }
+    *link = node->next;
+    node->process = NULL;
+}
+
+/**
+ * @brief Check whether enough processes of a set have terminated
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param processes Processes to check
+ * @param count Number of processes
+ * @param wait_all true if every process must have terminated, false if any is enough
+ * @param index Receives the index of a terminated process (wait any only)
+ * @param exit_status Receives the exit status of that process (may be NULL)
+ * @return int 1 if the wait is satisfied, 0 if not, -EINVAL on an invalid handle
+ */
+static int check_set( const dmosi_process_t* processes, size_t count, bool wait_all, size_t* index, int* exit_status )
+{
+    bool satisfied = wait_all;
+    for(size_t i = 0; i < count; i++)
+    {
+        if(!validate_process(processes[i]))
+        {
+            DMOD_LOG_ERROR("Invalid process handle at index %zu provided to wait on processes\n", i);
+            return -EINVAL;
+        }
+        bool terminated = load_state(processes[i]) == DMOSI_PROCESS_STATE_TERMINATED;
+        if(wait_all)
+        {
+            satisfied = satisfied && terminated;
+        }
+        else if(terminated && !satisfied)
+        {
+            satisfied = true;
+            *index = i;
+            if(exit_status)
+                *exit_status = load_exit_status(processes[i]);
+        }
+    }
+    return satisfied ? 1 : 0;
+}
+
+/**
+ * @brief Block until the pending count of a wait set drops to zero
+ *
+ * @note Must be called inside the critical section with the nodes of the
+ * set registered; the critical section is held again on return
+ *
+ * @param set Wait set to block on
+ * @param timeout_ms Timeout in milliseconds (negative = infinite)
+ * @return int 0 when the set is satisfied, -ETIMEDOUT on timeout
+ */
+static int block_on_set( wait_set_t* set, int32_t timeout_ms )
+{
+    int32_t elapsed = 0;
+    while(set->pending > 0)
+    {
+        if(timeout_ms >= 0 && elapsed >= timeout_ms)
+            return -ETIMEDOUT;
+
+        Dmod_ExitCritical();
+        if(set->wakeup)
+        {
+            // kill and destroy post the semaphore once the last needed process terminates
+            dmosi_semaphore_wait(set->wakeup, timeout_ms);
+            elapsed = timeout_ms;
+        }
+        else
+        {
+            dmosi_thread_sleep(WAIT_POLL_INTERVAL_MS);
+            elapsed += WAIT_POLL_INTERVAL_MS;
+        }
+        Dmod_EnterCritical();
+    }
+    return 0;
+}
+
+/**
+ * @brief Block until enough processes of a set have terminated
+ *
+ * The processes are watched through one node each, so every termination
+ * costs one counter update and only the last needed one posts the
+ * semaphore of the set.
+ *
+ * @param processes Processes to wait for
+ * @param count Number of processes
+ * @param wait_all true to wait for every process, false to wait for any of them
+ * @param timeout_ms Timeout in milliseconds (negative = infinite)
+ * @param index Receives the index of a terminated process (wait any only)
+ * @param exit_status Receives the exit status of that process (may be NULL)
+ * @return int 0 on success, -EINVAL, -ENOMEM or -ETIMEDOUT on failure
+ */
+static int wait_for_set( const dmosi_process_t* processes, size_t count, bool wait_all, int32_t timeout_ms, size_t* index, int* exit_status )
+{
+    if(timeout_ms == 0)
+    {
+        Dmod_EnterCritical();
+        int checked = check_set(processes, count, wait_all, index, exit_status);
+        Dmod_ExitCritical();
+        return checked < 0 ? checked : (checked ? 0 : -ETIMEDOUT);
+    }
+
+    wait_node_t* nodes = Dmod_Malloc(sizeof(wait_node_t) * count);
+    if(!nodes)
+    {
+        DMOD_LOG_ERROR("Failed to allocate memory to wait on %zu processes\n", count);
+        return -ENOMEM;
+    }
+    wait_set_t set = { dmosi_semaphore_create(0, 1), 0 };
+
+    Dmod_EnterCritical();
+    int checked = check_set(processes, count, wait_all, index, exit_status);
+    for(size_t i = 0; i < count; i++)
+    {
+        nodes[i].process = NULL;
+        nodes[i].fired = false;
+        if(checked == 0 && load_state(processes[i]) != DMOSI_PROCESS_STATE_TERMINATED)
+        {
+            watch_process(&nodes[i], &set, processes[i]);
+            set.pending++;
+        }
+    }
+    if(!wait_all && set.pending > 0)
+    {
+        set.pending = 1;
+    }
+
+    int result = checked < 0 ? checked : block_on_set(&set, timeout_ms);
+    for(size_t i = 0; i < count; i++)
+    {
+        if(checked == 0 && result == 0 && !wait_all && nodes[i].fired)
+        {
+            *index = i;
+            if(exit_status)
+                *exit_status = nodes[i].exit_status;
+            checked = 1;
+        }
+        unwatch_process(&nodes[i]);
+    }
+    Dmod_ExitCritical();
+
+    if(set.wakeup)
+    {
+        dmosi_semaphore_destroy(set.wakeup);
+    }
+    Dmod_Free(nodes);
+    return result;
+}
+
+/**
+ * @brief Push a chain of processes onto the reaper queue
+ *
+ * Lock-free, so it may be called from any context.
+ *
+ * @param first First process of the chain
+ * @param last Last process of the chain
+ */
+static void reap_push( dmosi_process_t first, dmosi_process_t last )
+{
+    dmosi_process_t head = atomic_load_explicit(&reap_queue, memory_order_relaxed);
+    do
+    {
+        last->reap_next = head;
+    } while(!atomic_compare_exchange_weak_explicit(&reap_queue, &head, first, memory_order_release, memory_order_relaxed));
+}
+
+/**
+ * @brief Queue a process for the reaper unless it is already queued
+ *
+ * @return bool true if the process has been queued, false if it already was
+ */
+static bool reap_enqueue( dmosi_process_t process )
+{
+    if(atomic_exchange_explicit(&process->reap_queued, true, memory_order_relaxed))
+        return false;
+
+    reap_push(process, process);
+    dmosi_semaphore_t wakeup = reaper_wakeup;
+    if(wakeup)
+    {
+        dmosi_semaphore_post(wakeup);
+    }
+    return true;
+}
+
+/**
+ * @brief Kill a batch of threads of a process
+ *
+ * @param process Process the threads belong to (for logging)
+ * @param threads Threads to kill
+ * @param count Number of threads in the batch
+ * @param status Exit status code to pass to threads
+ * @return bool true on success, false on failure
+ */
+static bool kill_thread_batch( dmosi_process_t process, dmosi_thread_t* threads, size_t count, int status )
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        if(!dmosi_thread_kill(threads[i], status))
+        {
+            DMOD_LOG_ERROR("Failed to kill thread in process %s of module %s\n", process->name, process->module->name);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Kill all threads of a process using a heap-allocated handle array
+ *
+ * Only used when the thread layer keeps killed threads enumerable, so that
+ * refilling the on-stack batch would not make progress. The thread API
+ * has no offset into the thread list, so the whole list is fetched at
+ * once; this is the only allocation of a kill.
+ *
+ * @param process Process handle whose threads to kill
+ * @param count Number of threads of the process
+ * @param status Exit status code to pass to threads
+ * @return bool true on success, false on failure
+ */
+static bool kill_threads_allocating( dmosi_process_t process, size_t count, int status )
+{
+    dmosi_thread_t* threads = Dmod_MallocEx(sizeof(dmosi_thread_t) * count, process->module->name);
+    if(!threads)
+    {
+        DMOD_LOG_ERROR("Failed to allocate memory for thread handles while killing process %s of module %s\n", process->name, process->module->name);
+        return false;
+    }
+
+    size_t actual_count = dmosi_thread_get_by_process(process, threads, count);
+    if(actual_count != count)
+    {
+        DMOD_LOG_WARN("Thread count mismatch while killing process %s of module %s: expected %zu, got %zu\n", process->name, process->module->name, count, actual_count);
+    }
+    actual_count = actual_count < count ? actual_count : count;
+
+    bool result = kill_thread_batch(process, threads, actual_count, status);
+    Dmod_Free(threads);
+    return result;
+}
+
+/**
+ * @brief Take attached threads of a process that have not been killed yet
+ *
+ * @note Must be called inside the critical section
+ *
+ * @param process Process whose threads to take
+ * @param batch Buffer for the thread handles
+ * @param max_count Capacity of the buffer
+ * @return size_t Number of threads taken
+ */
+static size_t take_attached_threads( dmosi_process_t process, dmosi_thread_t* batch, size_t max_count )
+{
+    size_t count = 0;
+    for(dmosi_process_thread_link_t* link = process->threads; link && count < max_count; link = link->next)
+    {
+        if(link->killed)
+            continue;
+        link->killed = true;
+        batch[count++] = link->thread;
+    }
+    return count;
+}
+
+/**
+ * @brief Flag an attached thread of a process whose kill failed
+ *
+ * Nothing is flagged if the thread has been detached meanwhile.
+ *
+ * @note Must be called inside the critical section
+ */
+static void flag_kill_failed( dmosi_process_t process, dmosi_thread_t thread )
+{
+    for(dmosi_process_thread_link_t* link = process->threads; link; link = link->next)
+    {
+        if(link->thread == thread)
+        {
+            link->kill_failed = true;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Hand the threads whose kill failed back to the next kill
+ *
+ * Called once the kill has taken every thread, so a thread that keeps
+ * failing is tried once per kill instead of forever.
+ *
+ * @note Must be called inside the critical section
+ */
+static void rearm_failed_threads( dmosi_process_t process )
+{
+    for(dmosi_process_thread_link_t* link = process->threads; link; link = link->next)
+    {
+        if(link->kill_failed)
+        {
+            link->kill_failed = false;
+            link->killed = false;
+        }
+    }
+}
+
+/**
+ * @brief Kill the threads attached to a process
+ *
+ * Walks only the process's own thread list. Threads are taken in fixed
+ * on-stack batches and killed outside the critical section. Threads
+ * that fail to die are handed back as not killed, so a later kill
+ * retries them.
+ *
+ * @param process Process handle whose threads to kill
+ * @param status Exit status code to pass to threads
+ * @return bool true on success, false on failure
+ */
+static bool kill_attached_threads( dmosi_process_t process, int status )
+{
+    dmosi_thread_t batch[KILL_BATCH_SIZE];
+    bool result = true;
+
+    for(;;)
+    {
+        Dmod_EnterCritical();
+        size_t count = take_attached_threads(process, batch, KILL_BATCH_SIZE);
+        Dmod_ExitCritical();
+        if(count == 0)
+            break;
+
+        for(size_t i = 0; i < count; i++)
+        {
+            if(!dmosi_thread_kill(batch[i], status))
+            {
+                DMOD_LOG_ERROR("Failed to kill thread in process %s of module %s\n", process->name, process->module->name);
+                Dmod_EnterCritical();
+                flag_kill_failed(process, batch[i]);
+                Dmod_ExitCritical();
+                result = false;
+            }
+        }
+    }
+    if(!result)
+    {
+        Dmod_EnterCritical();
+        rearm_failed_threads(process);
+        Dmod_ExitCritical();
+    }
+    return result;
+}
+
+/**
+ * @brief Detach the threads that are still attached to a destroyed process
+ *
+ * @note Must be called inside the critical section
+ */
+static void detach_threads( dmosi_process_t process )
+{
+    for(dmosi_process_thread_link_t* link = process->threads; link; link = link->next)
+    {
+        link->process = NULL;
+    }
+    process->threads = NULL;
+    process->thread_count = 0;
+}
+
+/**
+ * @brief Kill all threads associated with a process
+ *
+ * Threads are fetched into a fixed on-stack batch that is refilled until
+ * the process has no threads left. Killing does not allocate when the
+ * thread registry is active, when the process has at most
+ * KILL_BATCH_SIZE threads, or when the thread layer drops killed threads
+ * from its list. Otherwise the remaining threads are killed through one
+ * heap-allocated array, and the kill fails if that allocation fails.
+ *
+ * @param process Process handle whose threads to kill
+ * @param status Exit status code to pass to threads
+ * @return bool true on success, false on failure
+ */
+static bool kill_threads( dmosi_process_t process, int status )
+{
+    if(atomic_load_explicit(&thread_registry_active, memory_order_relaxed))
+        return kill_attached_threads(process, status);
+
+    dmosi_thread_t batch[KILL_BATCH_SIZE];
+    size_t remaining = dmosi_thread_get_by_process(process, NULL, 0);
+
+    while(remaining > 0)
+    {
+        size_t count = dmosi_thread_get_by_process(process, batch, KILL_BATCH_SIZE);
+        count = count < KILL_BATCH_SIZE ? count : KILL_BATCH_SIZE;
+        if(!kill_thread_batch(process, batch, count, status))
+            return false;
+
+        if(remaining <= KILL_BATCH_SIZE)
+            break; // The whole process fitted into a single batch
+
+        size_t left = dmosi_thread_get_by_process(process, NULL, 0);
+        if(left >= remaining)
+        {
+            DMOD_LOG_VERBOSE("Killed threads of process %s are still listed, killing the rest in one pass\n", process->name);
+            return kill_threads_allocating(process, left, status);
+        }
+        remaining = left;
+    }
+    return true;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_create,(const char* name, const char* module_name, dmosi_process_t parent) )
+{
+    if(name == NULL)
+    {
+        DMOD_LOG_ERROR("Process name cannot be NULL\n");
+        return NULL;
+    }
+    module_name = module_name ? module_name : DMOSI_SYSTEM_MODULE_NAME;
+    dmosi_process_t process = process_alloc(module_name);
+    if(!process)
+    {
+        DMOD_LOG_ERROR("Failed to allocate memory for process %s of module %s\n", name, module_name);
+        return NULL;
+    }
+
+    process->batch = NULL;
+    char* stored_name = store_string(name_buffer(process), DMOSI_PROC_POOL_NAME_LENGTH, name);
+    if(!stored_name)
+    {
+        DMOD_LOG_ERROR("Failed to duplicate process name %s for module %s\n", name, module_name);
+        Dmod_EnterCritical();
+        process_free(process);
+        Dmod_ExitCritical();
+        return NULL;
+    }
+    init_process(process, stored_name, parent, 0);
+
+    Dmod_EnterCritical();
+    process->parent = live_parent(process->parent);
+    inherit_attributes(process);
+    bool registered = index_reserve(&name_index, 1) && index_reserve(&pid_index, 1);
+    if(registered)
+    {
+        process->module = module_acquire(module_name, 1);
+        registered = process->module != NULL;
+    }
+    char* pwd = NULL;
+    if(registered)
+    {
+        registered = inherit_pwd(process->parent, process, 1, &pwd);
+        atomic_store_explicit(&process->pwd, pwd, memory_order_relaxed);
+    }
+    if(registered)
+    {
+        process->pid = pid_alloc(1);
+        registered = process->pid != 0;
+        process->group = process->parent ? process->parent->group : process->pid;
+    }
+    if(registered)
+    {
+        register_process(process);
+    }
+    else
+    {
+        module_release(process->module, 1);
+        release_pwd(process, pwd);
+        process->magic = 0;
+        release_string(name_buffer(process), process->name);
+        process_free(process);
+    }
+    Dmod_ExitCritical();
+    if(!registered)
+    {
+        DMOD_LOG_ERROR("Failed to register process %s of module %s\n", name, module_name);
+        return NULL;
+    }
+
+    trace_event(DMOSI_PROCESS_TRACE_CREATE, process->pid, 0);
+    DMOD_LOG_VERBOSE("Created process %s of module %s\n", name, module_name);
+    return process;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _process_destroy, (dmosi_process_t process) )
+{
+    if(!process)
+    {
+        DMOD_LOG_ERROR("Cannot destroy NULL process\n");
+        return;
+    }
+    DMOD_LOG_VERBOSE("Destroying process %s of module %s\n", process->name, process->module->name);
+
+    trace_event(DMOSI_PROCESS_TRACE_DESTROY, process->pid, load_exit_status(process));
+
+    // Phase 1: make the process unreachable for lookups and tree walks
+    Dmod_EnterCritical();
+    index_remove(&pid_index, process);
+    index_remove(&name_index, process);
+    handle_retire(process->pid);
+    pid_release(process->pid);
+    group_release(process->group);
+    unlink_process(process);
+    process->dying = true;
+    Dmod_ExitCritical();
+
+    // Phase 2: tear down threads without stalling the rest of the system
+    int exit_status = load_exit_status(process);
+    if(!kill_threads(process, exit_status))
+    {
+        DMOD_LOG_ERROR("Failed to kill threads while destroying process %s of module %s\n", process->name, process->module->name);
+    }
+
+    // Phase 3: wake waiters and wait for them to leave
+    exit_callback_t* fired = NULL;
+    Dmod_EnterCritical();
+    store_terminated(process, exit_status);
+    signal_waiters(process);
+    take_exit_callbacks(process, &fired);
+    detach_watchers(process);
+    detach_threads(process);
+    while(process->waiters > 0)
+    {
+        Dmod_ExitCritical();
+        dmosi_thread_sleep(1);
+        Dmod_EnterCritical();
+    }
+    process->magic = 0; // Invalidate the process handle
+    Dmod_ExitCritical();
+    run_exit_callbacks(fired);
+
+    // Phase 4: nothing references the process anymore
+    if(process->done)
+    {
+        dmosi_semaphore_destroy(process->done);
+    }
+    release_string(name_buffer(process), process->name);
+    release_pwd(process, atomic_load_explicit(&process->pwd, memory_order_relaxed));
+    release_pwd(process, process->retired_pwd);
+
+    Dmod_EnterCritical();
+    module_release(process->module, 1);
+    process_free(process);
+    Dmod_ExitCritical();
+}
+
+/**
+ * @brief Kill a process without queueing it for the reaper
+ *
+ * @param process Process handle
+ * @param status Exit status code
+ * @param auto_reap Set to true if the process has to be queued for the reaper
+ * @return int 0 on success, -EFAULT if its threads could not be killed
+ */
+static int kill_process( dmosi_process_t process, int status, bool* auto_reap )
+{
+    DMOD_LOG_VERBOSE("Killing process %s of module %s with status %d\n", process->name, process->module->name, status);
+    trace_event(DMOSI_PROCESS_TRACE_KILL, process->pid, status);
+
+    if(!kill_threads(process, status))
+    {
+        DMOD_LOG_ERROR("Failed to kill threads while killing process %s of module %s\n", process->name, process->module->name);
+        return -EFAULT;
+    }
+
+    exit_callback_t* fired = NULL;
+    Dmod_EnterCritical();
+    store_terminated(process, status);
+    signal_waiters(process);
+    take_exit_callbacks(process, &fired);
+    *auto_reap = process->auto_reap;
+    Dmod_ExitCritical();
+    run_exit_callbacks(fired);
+    return 0;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_kill, (dmosi_process_t process, int status) )
+{
+    if(!process)
+    {
+        DMOD_LOG_ERROR("Cannot kill NULL process\n");
+        return -EINVAL;
+    }
+
+    bool auto_reap = false;
+    int result = kill_process(process, status, &auto_reap);
+    if(auto_reap)
+    {
+        reap_enqueue(process);
+    }
+    return result;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_wait, (dmosi_process_t process, int32_t timeout_ms) )
+{
+    if(!process)
+    {
+        DMOD_LOG_ERROR("Cannot wait for NULL process\n");
+        return -EINVAL;
+    }
+    DMOD_LOG_VERBOSE("Waiting for process %s of module %s to terminate with timeout %d ms\n", process->name, process->module->name, timeout_ms);
+
+    // The process may be gone once the wait returns, so keep its ID
+    dmosi_process_id_t pid = process->pid;
+    trace_event(DMOSI_PROCESS_TRACE_WAIT_ENTER, pid, timeout_ms);
+    int result = wait_for_termination(process, timeout_ms);
+    trace_event(DMOSI_PROCESS_TRACE_WAIT_EXIT, pid, result);
+    return result;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_current,   (void) )
+{
+    if(!dmosi_is_started())
+    {
+        return NULL;
+    }
+    dmosi_thread_t current_thread = dmosi_thread_current();
+    if(!current_thread)
+    {
+        DMOD_LOG_ERROR("Failed to get current thread while retrieving current process\n");
+        return NULL;
+    }
+    dmosi_process_t process = dmosi_thread_get_process(current_thread);
+    if(!process)
+    {
+        DMOD_LOG_ERROR("Current thread does not belong to any process\n");
+        return NULL;
+    }
+    return process;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_get_exit_status, (dmosi_process_t process) )
+{
+    GETTER_CHECK(process, -EINVAL, "Cannot get exit status of NULL process\n");
+    return load_exit_status(process);
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_state_t, _process_get_state, (dmosi_process_t process) )
+{
+    GETTER_CHECK(process, -EINVAL, "Cannot get state of NULL process\n");
+    return load_state(process);
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_id_t, _process_get_id, (dmosi_process_t process) )
+{
+    GETTER_CHECK(process, 0, "Cannot get ID of NULL process\n");
+    return process->pid;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _process_get_name, (dmosi_process_t process) )
+{
+    GETTER_CHECK(process, NULL, "Cannot get name of NULL process\n");
+    return process->name;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _process_get_module_name, (dmosi_process_t process) )
+{
+    GETTER_CHECK(process, NULL, "Cannot get module name of NULL process\n");
+    return process->module->name;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int,            _process_set_uid,   (dmosi_process_t process, dmosi_user_id_t uid) )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to set UID\n");
+        return -EINVAL;
+    }
+    process->uid = uid;
+    return 0;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_user_id_t, _process_get_uid,   (dmosi_process_t process) )
+{
+    GETTER_CHECK(validate_process(process), 0, "Invalid process handle provided to get UID\n");
+    return process->uid;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_get_parent, (dmosi_process_t process) )
+{
+    GETTER_CHECK(process, NULL, "Cannot get parent of NULL process\n");
+    return process->parent;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_id, (dmosi_process_t process, dmosi_process_id_t pid) )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to set process ID\n");
+        return -EINVAL;
+    }
+    DMOD_LOG_VERBOSE("Setting process ID of %s to %u\n", process->name, pid);
+
+    if(pid == 0)
+    {
+        DMOD_LOG_ERROR("Process ID cannot be 0\n");
+        return -EINVAL;
+    }
+
+    Dmod_EnterCritical();
+    if(pid == process->pid)
+    {
+        Dmod_ExitCritical();
+        return 0;
+    }
+    if(find_by_pid(pid) || pid_names_group(pid))
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_ERROR("Cannot set ID of process %s to %u: ID already in use\n", process->name, pid);
+        return -EEXIST;
+    }
+    // Reserve first so that a failed allocation leaves the old ID registered
+    if(!index_reserve(&pid_index, 1) || !pid_claim(pid))
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_ERROR("Failed to register process %s under ID %u\n", process->name, pid);
+        return -ENOMEM;
+    }
+    index_remove(&pid_index, process);
+    handle_retire(process->pid);
+    pid_release(process->pid);
+    process->pid = pid;
+    index_insert(&pid_index, process);
+    handle_publish(process, pid);
+    Dmod_ExitCritical();
+    return 0;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_module_name, (dmosi_process_t process, const char* module_name) )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to set module name\n");
+        return -EINVAL;
+    }
+    if(!module_name)
+    {
+        DMOD_LOG_ERROR("Module name cannot be NULL\n");
+        return -EINVAL;
+    }
+    if(strlen(module_name) >= DMOD_MAX_MODULE_NAME_LENGTH)
+    {
+        DMOD_LOG_ERROR("Module name too long: %s\n", module_name);
+        return -EINVAL;
+    }
+    DMOD_LOG_VERBOSE("Setting module name of process %s to %s\n", process->name, module_name);
+
+    Dmod_EnterCritical();
+    module_entry_t* module = module_acquire(module_name, 1);
+    if(module)
+    {
+        module_release(process->module, 1);
+        process->module = module;
+    }
+    Dmod_ExitCritical();
+    if(!module)
+    {
+        DMOD_LOG_ERROR("Failed to allocate memory for module name %s\n", module_name);
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_pwd, (dmosi_process_t process, const char* pwd) )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to set working directory\n");
+        return -EINVAL;
+    }
+    if(!pwd)
+    {
+        DMOD_LOG_ERROR("Working directory cannot be NULL\n");
+        return -EINVAL;
+    }
+    DMOD_LOG_VERBOSE("Setting working directory of process %s to %s\n", process->name, pwd);
+
+    // Readers load the pointer without locking and are not tracked. The
+    // replaced string is retired rather than freed and only released (or
+    // its inline buffer rewritten) by the next update, which covers readers
+    // that finish within one update; dmosi_process_copy_pwd covers the rest
+    Dmod_EnterCritical();
+    char* current = atomic_load_explicit(&process->pwd, memory_order_relaxed);
+    if(pwd == current)
+    {
+        Dmod_ExitCritical();
+        return 0;
+    }
+
+    char* fresh;
+    if(pwd == process->retired_pwd)
+    {
+        fresh = process->retired_pwd;
+    }
+    else
+    {
+        // Copy on write: shared strings of other processes are never modified
+        fresh = store_pwd(process, current, pwd);
+        if(!fresh)
+        {
+            Dmod_ExitCritical();
+            DMOD_LOG_ERROR("Failed to allocate memory for working directory\n");
+            return -ENOMEM;
+        }
+        release_pwd(process, process->retired_pwd);
+    }
+    atomic_store_explicit(&process->pwd, fresh, memory_order_release);
+    process->retired_pwd = current;
+    Dmod_ExitCritical();
+
+    return 0;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _process_get_pwd, (dmosi_process_t process) )
+{
+    GETTER_CHECK(validate_process(process), NULL, "Invalid process handle provided to get working directory\n");
+    
+    // Return stored pwd or default to root if not set
+    const char* pwd = atomic_load_explicit(&process->pwd, memory_order_acquire);
+    return pwd ? pwd : "/";
+}
+
+int dmosi_process_copy_pwd( dmosi_process_t process, char* buffer, size_t size )
+{
+    if(!validate_process(process) || buffer == NULL)
+    {
+        DMOD_LOG_ERROR("Invalid arguments provided to copy working directory\n");
+        return -EINVAL;
+    }
+
+    Dmod_EnterCritical();
+    const char* pwd = atomic_load_explicit(&process->pwd, memory_order_relaxed);
+    pwd = pwd ? pwd : "/";
+    size_t length = strlen(pwd);
+    if(length >= size)
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_ERROR("Buffer of %zu bytes is too small for working directory of process %s\n", size, process->name);
+        return -ERANGE;
+    }
+    memcpy(buffer, pwd, length + 1);
+    Dmod_ExitCritical();
+    return 0;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_exit_status, (dmosi_process_t process, int exit_status) )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to set exit status\n");
+        return -EINVAL;
+    }
+    DMOD_LOG_VERBOSE("Setting exit status of process %s to %d\n", process->name, exit_status);
+    atomic_store_explicit(&process->exit_status, exit_status, memory_order_relaxed);
+    return 0;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_find_by_name, (const char* name) )
+{
+    if(!name)
+    {
+        DMOD_LOG_ERROR("Process name cannot be NULL\n");
+        return NULL;
+    }
+    DMOD_LOG_VERBOSE("Searching for process: %s\n", name);
+
+    Dmod_EnterCritical();
+    dmosi_process_t process = find_by_name(name);
+    dmosi_process_id_t pid = process ? process->pid : 0;
+    Dmod_ExitCritical();
+
+    trace_event(DMOSI_PROCESS_TRACE_FIND, pid, 0);
+    return process;
+}
+
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_find_by_id, (dmosi_process_id_t pid) )
+{
+    if(pid == 0)
+    {
+        DMOD_LOG_ERROR("Process ID cannot be 0\n");
+        return NULL;
+    }
+    
+    DMOD_LOG_VERBOSE("Searching for process: ID %u\n", pid);
+
+    Dmod_EnterCritical();
+    dmosi_process_t process = find_by_pid(pid);
+    Dmod_ExitCritical();
+
+    trace_event(DMOSI_PROCESS_TRACE_FIND, pid, process != NULL);
+    return process;
+}
+
+dmosi_process_t dmosi_process_get_first_child( dmosi_process_t process )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to get first child\n");
+        return NULL;
+    }
+    return process->first_child;
+}
+
+dmosi_process_t dmosi_process_get_next_sibling( dmosi_process_t process )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to get next sibling\n");
+        return NULL;
+    }
+    return process->next_sibling;
+}
+
+size_t dmosi_process_get_children( dmosi_process_t process, dmosi_process_t* children, size_t max_count )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to get children\n");
+        return 0;
+    }
+
+    size_t count = 0;
+    Dmod_EnterCritical();
+    for(dmosi_process_t child = process->first_child; child; child = child->next_sibling)
+    {
+        if(children)
+        {
+            if(count >= max_count)
+                break;
+            children[count] = child;
+        }
+        count++;
+    }
+    Dmod_ExitCritical();
+    return count;
+}
+
+/**
+ * @brief Queue the terminated auto-reaped processes of a subtree for the reaper
+ *
+ * Walks the subtree in post-order and reads the links of a node before
+ * queueing it, so a node the reaper destroys meanwhile is never touched
+ * again: its children have been visited already and its parent and next
+ * sibling are still unqueued.
+ *
+ * @param root Root of the subtree
+ */
+static void reap_tree( dmosi_process_t root )
+{
+    Dmod_EnterCritical();
+    dmosi_process_t node = root;
+    while(node->first_child)
+    {
+        node = node->first_child;
+    }
+    for(;;)
+    {
+        dmosi_process_t next = NULL;
+        if(node != root)
+        {
+            next = node->next_sibling;
+            if(next)
+            {
+                while(next->first_child)
+                {
+                    next = next->first_child;
+                }
+            }
+            else
+            {
+                next = node->parent;
+            }
+        }
+        bool queue = node->auto_reap && load_state(node) == DMOSI_PROCESS_STATE_TERMINATED;
+        Dmod_ExitCritical();
+
+        if(queue)
+        {
+            reap_enqueue(node);
+        }
+        if(!next)
+            return;
+
+        node = next;
+        Dmod_EnterCritical();
+    }
+}
+
+int dmosi_process_kill_tree( dmosi_process_t process, int status )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to kill process tree\n");
+        return -EINVAL;
+    }
+    DMOD_LOG_VERBOSE("Killing process tree of %s with status %d\n", process->name, status);
+
+    // Iterative pre-order walk over the first-child/next-sibling links.
+    // Nothing is queued for the reaper yet, so no node can disappear under the walk.
+    int result = 0;
+    bool auto_reap = false;
+    dmosi_process_t node = process;
+    while(node)
+    {
+        // Terminated processes keep their exit status, their descendants are still killed
+        if(load_state(node) != DMOSI_PROCESS_STATE_TERMINATED)
+        {
+            result = kill_process(node, status, &auto_reap);
+            if(result != 0)
+                break;
+        }
+
+        if(node->first_child)
+        {
+            node = node->first_child;
+            continue;
+        }
+        while(node != process && !node->next_sibling)
+        {
+            node = node->parent;
+        }
+        node = node == process ? NULL : node->next_sibling;
+    }
+
+    reap_tree(process);
+    return result;
+}
+
+int dmosi_process_create_many( const char* name_prefix, const char* module_name, dmosi_process_t parent, size_t count, dmosi_process_t* processes )
+{
+    if(name_prefix == NULL || processes == NULL || count == 0)
+    {
+        DMOD_LOG_ERROR("Invalid arguments provided to create processes in batch\n");
+        return -EINVAL;
+    }
+    module_name = module_name ? module_name : DMOSI_SYSTEM_MODULE_NAME;
+
+    // One block for the header, the processes and their names
+    char index_digits[20];
+    size_t prefix_length = strlen(name_prefix);
+    size_t name_size = prefix_length + format_decimal(index_digits, count - 1) + 1;
+    size_t block_size = sizeof(process_batch_t) + sizeof(struct dmosi_process) * count + name_size * count;
+    process_batch_t* batch = Dmod_MallocEx(block_size, module_name);
+    if(!batch)
+    {
+        DMOD_LOG_ERROR("Failed to allocate memory for %zu processes %s of module %s\n", count, name_prefix, module_name);
+        return -ENOMEM;
+    }
+    batch->live = count;
+    batch->name_size = name_size;
+    batch->processes = (struct dmosi_process*)(batch + 1);
+    batch->names = (char*)(batch->processes + count);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        dmosi_process_t process = &batch->processes[i];
+        process->batch = batch;
+
+        char* name = name_buffer(process);
+        memcpy(name, name_prefix, prefix_length);
+        name[prefix_length + format_decimal(&name[prefix_length], i)] = '\0';
+
+        init_process(process, name, parent, 0);
+    }
+
+    Dmod_EnterCritical();
+    parent = live_parent(parent);
+    dmosi_process_id_t first_pid = 0;
+    module_entry_t* module = NULL;
+    if(index_reserve(&pid_index, count) && index_reserve(&name_index, count))
+    {
+        module = module_acquire(module_name, count);
+    }
+    char* pwd = NULL;
+    if(module && inherit_pwd(parent, NULL, count, &pwd))
+    {
+        first_pid = pid_alloc(count);
+    }
+    if(first_pid == 0)
+    {
+        module_release(module, count);
+        if(pwd && atomic_fetch_sub_explicit(&shared_pwd_of(pwd)->refs, count, memory_order_relaxed) == count)
+        {
+            Dmod_Free(shared_pwd_of(pwd));
+        }
+        Dmod_ExitCritical();
+        DMOD_LOG_ERROR("Failed to register %zu processes %s of module %s\n", count, name_prefix, module_name);
+        Dmod_Free(batch);
+        return -ENOMEM;
+    }
+    for(size_t i = 0; i < count; i++)
+    {
+        dmosi_process_t process = &batch->processes[i];
+        process->pid = first_pid + (dmosi_process_id_t)i;
+        process->parent = parent;
+        inherit_attributes(process);
+        process->module = module;
+        process->group = process->parent ? process->parent->group : process->pid;
+        atomic_store_explicit(&process->pwd, pwd, memory_order_relaxed);
+        register_process(process);
+        processes[i] = process;
+    }
+    Dmod_ExitCritical();
+
+    for(size_t i = 0; i < count; i++)
+    {
+        trace_event(DMOSI_PROCESS_TRACE_CREATE, first_pid + (dmosi_process_id_t)i, 0);
+    }
+
+    DMOD_LOG_VERBOSE("Created %zu processes %s0..%s%zu of module %s\n", count, name_prefix, name_prefix, count - 1, module_name);
+    return 0;
+}
+
+dmosi_process_handle_t dmosi_process_get_handle( dmosi_process_t process )
+{
+    GETTER_CHECK(validate_process(process), DMOSI_PROCESS_HANDLE_INVALID, "Invalid process handle provided to get handle\n");
+    handle_slot_t* slot = handle_slot(process->pid);
+    if(!slot)
+        return DMOSI_PROCESS_HANDLE_INVALID;
+    uint32_t generation = atomic_load_explicit(&slot->generation, memory_order_relaxed);
+    return ((dmosi_process_handle_t)generation << 32) | process->pid;
+}
+
+bool dmosi_process_handle_is_valid( dmosi_process_handle_t handle )
+{
+    uint32_t generation = (uint32_t)(handle >> 32);
+    handle_slot_t* slot = handle_slot((dmosi_process_id_t)handle);
+    return slot && (generation & 1u) && atomic_load_explicit(&slot->generation, memory_order_acquire) == generation;
+}
+
+dmosi_process_t dmosi_process_from_handle( dmosi_process_handle_t handle )
+{
+    uint32_t generation = (uint32_t)(handle >> 32);
+    handle_slot_t* slot = handle_slot((dmosi_process_id_t)handle);
+    if(!slot || !(generation & 1u) || atomic_load_explicit(&slot->generation, memory_order_acquire) != generation)
+        return NULL;
+
+    dmosi_process_t process = atomic_load_explicit(&slot->process, memory_order_relaxed);
+    // A changed generation means the process was read while being replaced
+    atomic_thread_fence(memory_order_acquire);
+    if(atomic_load_explicit(&slot->generation, memory_order_relaxed) != generation)
+        return NULL;
+    return process;
+}
+
+size_t dmosi_process_get_all( dmosi_process_t* processes, size_t max_count )
+{
+    size_t count = 0;
+
+    Dmod_EnterCritical();
+    if(!processes)
+    {
+        count = pid_index.count;
+    }
+    else
+    {
+        for(size_t slot = 0; slot < pid_index.capacity && count < max_count; slot++)
+        {
+            if(pid_index.slots[slot])
+            {
+                processes[count++] = pid_index.slots[slot];
+            }
+        }
+    }
+    Dmod_ExitCritical();
+
+    return count;
+}
+
+size_t dmosi_process_for_each( dmosi_process_visitor_t visitor, void* context )
+{
+    if(!visitor)
+    {
+        DMOD_LOG_ERROR("Process visitor cannot be NULL\n");
+        return 0;
+    }
+
+    size_t visited = 0;
+
+    Dmod_EnterCritical();
+    for(size_t slot = 0; slot < pid_index.capacity; slot++)
+    {
+        dmosi_process_t process = pid_index.slots[slot];
+        if(!process)
+            continue;
+
+        visited++;
+        if(!visitor(process, context))
+            break;
+    }
+    Dmod_ExitCritical();
+
+    return visited;
+}
+
+dmosi_process_module_t dmosi_process_get_module( dmosi_process_t process )
+{
+    GETTER_CHECK(validate_process(process), DMOSI_PROCESS_MODULE_INVALID, "Invalid process handle provided to get module\n");
+    return process->module->id;
+}
+
+dmosi_process_module_t dmosi_process_find_module( const char* module_name )
+{
+    if(!module_name)
+    {
+        DMOD_LOG_ERROR("Module name cannot be NULL\n");
+        return DMOSI_PROCESS_MODULE_INVALID;
+    }
+
+    uint32_t hash = name_hash(module_name);
+
+    Dmod_EnterCritical();
+    module_entry_t* entry = module_lookup(module_name, hash);
+    dmosi_process_module_t id = entry ? entry->id : DMOSI_PROCESS_MODULE_INVALID;
+    Dmod_ExitCritical();
+
+    return id;
+}
+
+size_t dmosi_process_get_by_module( dmosi_process_module_t module, dmosi_process_t* processes, size_t max_count )
+{
+    size_t count = 0;
+
+    Dmod_EnterCritical();
+    module_entry_t* entry = module_by_id(module);
+    if(entry && !processes)
+    {
+        count = entry->refs;
+    }
+    else if(entry)
+    {
+        for(size_t slot = 0; slot < pid_index.capacity && count < max_count; slot++)
+        {
+            dmosi_process_t process = pid_index.slots[slot];
+            if(process && process->module == entry)
+            {
+                processes[count++] = process;
+            }
+        }
+    }
+    Dmod_ExitCritical();
+
+    return count;
+}
+
+/**
+ * @brief Query criteria resolved once before the registry is scanned
+ */
+typedef struct
+{
+    const dmosi_process_query_t* query;     /**< Original criteria */
+    module_entry_t* module;                 /**< Interned module of the module criterion */
+    uint32_t name_hash;                     /**< Hash of the name criterion */
+} query_plan_t;
+
+/**
+ * @brief Resolve the criteria of a query
+ *
+ * @note Must be called inside the critical section
+ *
+ * @return bool false if no process can match the query
+ */
+static bool query_prepare( const dmosi_process_query_t* query, query_plan_t* plan )
+{
+    plan->query = query;
+    plan->module = NULL;
+    plan->name_hash = 0;
+    if(query->fields & DMOSI_PROCESS_QUERY_MODULE)
+    {
+        plan->module = module_by_id(query->module);
+        if(!plan->module)
+            return false;
+    }
+    if(query->fields & DMOSI_PROCESS_QUERY_NAME)
+    {
+        if(!query->name)
+            return false;
+        plan->name_hash = name_hash(query->name);
+    }
+    return true;
+}
+
+/**
+ * @brief Check a process against resolved query criteria, integer fields first
+ *
+ * @note Must be called inside the critical section
+ */
+static bool query_matches( const query_plan_t* plan, dmosi_process_t process )
+{
+    const dmosi_process_query_t* query = plan->query;
+    uint32_t fields = query->fields;
+
+    if((fields & DMOSI_PROCESS_QUERY_STATE) && load_state(process) != query->state)
+        return false;
+    if((fields & DMOSI_PROCESS_QUERY_UID) && process->uid != query->uid)
+        return false;
+    if((fields & DMOSI_PROCESS_QUERY_GROUP) && process->group != query->group)
+        return false;
+    if((fields & DMOSI_PROCESS_QUERY_PARENT) && process->parent != query->parent)
+        return false;
+    if((fields & DMOSI_PROCESS_QUERY_MODULE) && process->module != plan->module)
+        return false;
+    if(fields & DMOSI_PROCESS_QUERY_NAME)
+        return process->name_hash == plan->name_hash && strcmp(process->name, query->name) == 0;
+    return true;
+}
+
+size_t dmosi_process_query( const dmosi_process_query_t* query, dmosi_process_t* processes, size_t max_count )
+{
+    if(!query)
+    {
+        DMOD_LOG_ERROR("Process query cannot be NULL\n");
+        return 0;
+    }
+
+    size_t count = 0;
+    query_plan_t plan;
+
+    Dmod_EnterCritical();
+    if(query_prepare(query, &plan))
+    {
+        for(size_t slot = 0; slot < pid_index.capacity && (!processes || count < max_count); slot++)
+        {
+            dmosi_process_t process = pid_index.slots[slot];
+            if(!process || !query_matches(&plan, process))
+                continue;
+
+            if(processes)
+            {
+                processes[count] = process;
+            }
+            count++;
+        }
+    }
+    Dmod_ExitCritical();
+
+    return count;
+}
+
+size_t dmosi_process_query_each( const dmosi_process_query_t* query, dmosi_process_visitor_t visitor, void* context )
+{
+    if(!query || !visitor)
+    {
+        DMOD_LOG_ERROR("Process query and visitor cannot be NULL\n");
+        return 0;
+    }
+
+    size_t visited = 0;
+    query_plan_t plan;
+
+    Dmod_EnterCritical();
+    if(query_prepare(query, &plan))
+    {
+        for(size_t slot = 0; slot < pid_index.capacity; slot++)
+        {
+            dmosi_process_t process = pid_index.slots[slot];
+            if(!process || !query_matches(&plan, process))
+                continue;
+
+            visited++;
+            if(!visitor(process, context))
+                break;
+        }
+    }
+    Dmod_ExitCritical();
+
+    return visited;
+}
+
+/**
+ * @brief Predicate selecting the processes affected by a bulk operation
+ *
+ * @note Called inside the critical section, and on thread owners outside it
+ */
+typedef bool (*process_match_t)( dmosi_process_t process, const void* key );
+
+static bool match_module( dmosi_process_t process, const void* key )
+{
+    return process->module == key;
+}
+
+static bool match_group( dmosi_process_t process, const void* key )
+{
+    return process->group == *(const dmosi_process_id_t*)key;
+}
+
+/**
+ * @brief Kill the attached threads of all matching processes
+ *
+ * @param match Predicate selecting the processes
+ * @param key Key passed to the predicate
+ * @param status Exit status code to pass to threads
+ * @return int 0 on success, -EFAULT on failure
+ */
+static int kill_matching_attached_threads( process_match_t match, const void* key, int status )
+{
+    dmosi_thread_t batch[KILL_BATCH_SIZE];
+    int result = 0;
+
+    for(;;)
+    {
+        size_t count = 0;
+        Dmod_EnterCritical();
+        for(size_t slot = 0; slot < pid_index.capacity && count < KILL_BATCH_SIZE; slot++)
+        {
+            dmosi_process_t process = pid_index.slots[slot];
+            if(process && match(process, key))
+            {
+                count += take_attached_threads(process, &batch[count], KILL_BATCH_SIZE - count);
+            }
+        }
+        Dmod_ExitCritical();
+        if(count == 0)
+            break;
+
+        for(size_t i = 0; i < count; i++)
+        {
+            if(!dmosi_thread_kill(batch[i], status))
+            {
+                DMOD_LOG_ERROR("Failed to kill thread while killing processes\n");
+                result = -EFAULT;
+                // The owner is searched again, it may have been destroyed meanwhile
+                Dmod_EnterCritical();
+                for(size_t slot = 0; slot < pid_index.capacity; slot++)
+                {
+                    dmosi_process_t process = pid_index.slots[slot];
+                    if(process && match(process, key))
+                    {
+                        flag_kill_failed(process, batch[i]);
+                    }
+                }
+                Dmod_ExitCritical();
+            }
+        }
+    }
+    if(result != 0)
+    {
+        Dmod_EnterCritical();
+        for(size_t slot = 0; slot < pid_index.capacity; slot++)
+        {
+            dmosi_process_t process = pid_index.slots[slot];
+            if(process && match(process, key))
+            {
+                rearm_failed_threads(process);
+            }
+        }
+        Dmod_ExitCritical();
+    }
+    return result;
+}
+
+/**
+ * @brief Kill all threads that belong to matching processes
+ *
+ * @param match Predicate selecting the processes
+ * @param key Key passed to the predicate
+ * @param status Exit status code to pass to threads
+ * @return int 0 on success, -ENOMEM or -EFAULT on failure
+ */
+static int kill_matching_threads( process_match_t match, const void* key, int status )
+{
+    if(atomic_load_explicit(&thread_registry_active, memory_order_relaxed))
+        return kill_matching_attached_threads(match, key, status);
+
+    size_t count = dmosi_thread_get_all(NULL, 0);
+    if(count == 0)
+        return 0;
+
+    dmosi_thread_t* threads = Dmod_Malloc(sizeof(dmosi_thread_t) * count);
+    if(!threads)
+    {
+        DMOD_LOG_ERROR("Failed to allocate memory for thread handles while killing processes\n");
+        return -ENOMEM;
+    }
+    count = dmosi_thread_get_all(threads, count);
+
+    int result = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        dmosi_process_t process = dmosi_thread_get_process(threads[i]);
+        if(!validate_process(process) || !match(process, key))
+            continue;
+
+        if(!dmosi_thread_kill(threads[i], status))
+        {
+            DMOD_LOG_ERROR("Failed to kill thread in process %s of module %s\n", process->name, process->module->name);
+            result = -EFAULT;
+        }
+    }
+    Dmod_Free(threads);
+    return result;
+}
+
+/**
+ * @brief Kill every matching process with one pass over the threads and one critical section
+ *
+ * Processes that have already terminated are skipped and not counted.
+ *
+ * @param match Predicate selecting the processes
+ * @param key Key passed to the predicate
+ * @param status Exit status passed to every killed process
+ * @return int Number of processes killed, -ENOMEM or -EFAULT on failure
+ */
+static int kill_matching( process_match_t match, const void* key, int status )
+{
+    int result = kill_matching_threads(match, key, status);
+
+    int killed = 0;
+    exit_callback_t* fired = NULL;
+    Dmod_EnterCritical();
+    if(result != -ENOMEM)
+    {
+        for(size_t slot = 0; slot < pid_index.capacity; slot++)
+        {
+            dmosi_process_t process = pid_index.slots[slot];
+            // Processes that already terminated keep their exit status
+            if(!process || !match(process, key) || load_state(process) == DMOSI_PROCESS_STATE_TERMINATED)
+                continue;
+
+            trace_event(DMOSI_PROCESS_TRACE_KILL, process->pid, status);
+            store_terminated(process, status);
+            signal_waiters(process);
+            take_exit_callbacks(process, &fired);
+            if(process->auto_reap)
+            {
+                reap_enqueue(process);
+            }
+            killed++;
+        }
+    }
+    Dmod_ExitCritical();
+    run_exit_callbacks(fired);
+
+    return result != 0 ? result : killed;
+}
+
+int dmosi_process_kill_module( dmosi_process_module_t module, int status )
+{
+    // Module entries are never freed, so the entry stays valid without a reference
+    Dmod_EnterCritical();
+    module_entry_t* entry = module_by_id(module);
+    Dmod_ExitCritical();
+    if(!entry)
+    {
+        DMOD_LOG_VERBOSE("No processes of module %u to kill\n", module);
+        return 0;
+    }
+    DMOD_LOG_VERBOSE("Killing processes of module %s with status %d\n", entry->name, status);
+
+    return kill_matching(match_module, entry, status);
+}
+
+int dmosi_process_set_group( dmosi_process_t process, dmosi_process_id_t group )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to set process group\n");
+        return -EINVAL;
+    }
+
+    Dmod_EnterCritical();
+    group = group ? group : process->pid;
+    if(group != process->pid && !pid_names_group(group))
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_ERROR("Cannot move process %s to group %u: no such group\n", process->name, group);
+        return -ESRCH;
+    }
+    // Acquire first so that rejoining the own group never frees its PID
+    group_acquire(group);
+    group_release(process->group);
+    process->group = group;
+    Dmod_ExitCritical();
+
+    DMOD_LOG_VERBOSE("Process %s of module %s joined group %u\n", process->name, process->module->name, process->group);
+    return 0;
+}
+
+dmosi_process_id_t dmosi_process_get_group( dmosi_process_t process )
+{
+    GETTER_CHECK(validate_process(process), 0, "Invalid process handle provided to get process group\n");
+    return process->group;
+}
+
+int dmosi_process_kill_group( dmosi_process_id_t group, int status )
+{
+    if(group == 0)
+    {
+        DMOD_LOG_ERROR("Process group cannot be 0\n");
+        return -EINVAL;
+    }
+    DMOD_LOG_VERBOSE("Killing process group %u with status %d\n", group, status);
+    return kill_matching(match_group, &group, status);
+}
+
+/**
+ * @brief Count the processes of a group that have not terminated yet
+ *
+ * @note Must be called inside the critical section
+ */
+static size_t count_running_in_group( dmosi_process_id_t group )
+{
+    size_t count = 0;
+    for(size_t slot = 0; slot < pid_index.capacity; slot++)
+    {
+        dmosi_process_t process = pid_index.slots[slot];
+        if(process && process->group == group && load_state(process) != DMOSI_PROCESS_STATE_TERMINATED)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+int dmosi_process_wait_group( dmosi_process_id_t group, int32_t timeout_ms )
+{
+    if(group == 0)
+    {
+        DMOD_LOG_ERROR("Process group cannot be 0\n");
+        return -EINVAL;
+    }
+
+    Dmod_EnterCritical();
+    size_t count = count_running_in_group(group);
+    Dmod_ExitCritical();
+    if(count == 0)
+        return 0;
+    if(timeout_ms == 0)
+        return -ETIMEDOUT;
+
+    wait_set_t set = { dmosi_semaphore_create(0, 1), 0 };
+    wait_node_t* nodes = NULL;
+    size_t capacity = 0;
+
+    // Members may join while the nodes are allocated outside the critical
+    // section, so the buffer grows until it holds every running member.
+    // Processes that join the group after the collecting pass are not waited for
+    Dmod_EnterCritical();
+    while(count > capacity)
+    {
+        Dmod_ExitCritical();
+        if(nodes)
+        {
+            Dmod_Free(nodes);
+        }
+        capacity = count;
+        nodes = Dmod_Malloc(sizeof(wait_node_t) * capacity);
+        if(!nodes)
+        {
+            DMOD_LOG_ERROR("Failed to allocate memory to wait on process group %u\n", group);
+            if(set.wakeup)
+            {
+                dmosi_semaphore_destroy(set.wakeup);
+            }
+            return -ENOMEM;
+        }
+        Dmod_EnterCritical();
+        count = count_running_in_group(group);
+    }
+    for(size_t slot = 0; slot < pid_index.capacity && set.pending < count; slot++)
+    {
+        dmosi_process_t process = pid_index.slots[slot];
+        if(process && process->group == group && load_state(process) != DMOSI_PROCESS_STATE_TERMINATED)
+        {
+            watch_process(&nodes[set.pending], &set, process);
+            set.pending++;
+        }
+    }
+    size_t watched = set.pending;
+
+    int result = block_on_set(&set, timeout_ms);
+    for(size_t i = 0; i < watched; i++)
+    {
+        unwatch_process(&nodes[i]);
+    }
+    Dmod_ExitCritical();
+
+    if(result == -ETIMEDOUT)
+    {
+        DMOD_LOG_WARN("Timeout while waiting for process group %u to terminate\n", group);
+    }
+    if(set.wakeup)
+    {
+        dmosi_semaphore_destroy(set.wakeup);
+    }
+    Dmod_Free(nodes);
+    return result;
+}
+
+int dmosi_process_wait_any( const dmosi_process_t* processes, size_t count, int32_t timeout_ms, int* exit_status )
+{
+    if(!processes || count == 0)
+    {
+        DMOD_LOG_ERROR("Invalid arguments provided to wait for any process\n");
+        return -EINVAL;
+    }
+
+    size_t index = 0;
+    int result = wait_for_set(processes, count, false, timeout_ms, &index, exit_status);
+    if(result == -ETIMEDOUT)
+    {
+        DMOD_LOG_WARN("Timeout while waiting for any of %zu processes to terminate\n", count);
+    }
+    return result == 0 ? (int)index : result;
+}
+
+int dmosi_process_wait_all( const dmosi_process_t* processes, size_t count, int32_t timeout_ms )
+{
+    if(!processes || count == 0)
+    {
+        DMOD_LOG_ERROR("Invalid arguments provided to wait for all processes\n");
+        return -EINVAL;
+    }
+
+    int result = wait_for_set(processes, count, true, timeout_ms, NULL, NULL);
+    if(result == -ETIMEDOUT)
+    {
+        DMOD_LOG_WARN("Timeout while waiting for all of %zu processes to terminate\n", count);
+    }
+    return result;
+}
+
+int dmosi_process_add_exit_callback( dmosi_process_t process, dmosi_process_exit_callback_t callback, void* context )
+{
+    if(!validate_process(process) || !callback)
+    {
+        DMOD_LOG_ERROR("Invalid arguments provided to add exit callback\n");
+        return -EINVAL;
+    }
+
+    exit_callback_t* entry = Dmod_MallocEx(sizeof(exit_callback_t), process->module->name);
+    if(!entry)
+    {
+        DMOD_LOG_ERROR("Failed to allocate memory for exit callback of process %s\n", process->name);
+        return -ENOMEM;
+    }
+    entry->callback = callback;
+    entry->context = context;
+    entry->process = process;
+
+    exit_callback_t* fired = NULL;
+    Dmod_EnterCritical();
+    entry->next = process->exit_callbacks;
+    process->exit_callbacks = entry;
+    if(load_state(process) == DMOSI_PROCESS_STATE_TERMINATED)
+    {
+        take_exit_callbacks(process, &fired);
+    }
+    Dmod_ExitCritical();
+    run_exit_callbacks(fired);
+
+    return 0;
+}
+
+int dmosi_process_remove_exit_callback( dmosi_process_t process, dmosi_process_exit_callback_t callback, void* context )
+{
+    if(!validate_process(process) || !callback)
+    {
+        DMOD_LOG_ERROR("Invalid arguments provided to remove exit callback\n");
+        return -EINVAL;
+    }
+
+    exit_callback_t* removed = NULL;
+    Dmod_EnterCritical();
+    for(exit_callback_t** link = &process->exit_callbacks; *link; link = &(*link)->next)
+    {
+        if((*link)->callback == callback && (*link)->context == context)
+        {
+            removed = *link;
+            *link = removed->next;
+            break;
+        }
+    }
+    Dmod_ExitCritical();
+
+    if(!removed)
+        return -ENOENT;
+    Dmod_Free(removed);
+    return 0;
+}
+
+int dmosi_process_attach_thread( dmosi_process_t process, dmosi_thread_t thread, dmosi_process_thread_link_t* link )
+{
+    if(!validate_process(process) || !thread || !link)
+    {
+        DMOD_LOG_ERROR("Invalid arguments provided to attach thread\n");
+        return -EINVAL;
+    }
+
+    link->thread = thread;
+    link->process = process;
+    link->prev = NULL;
+    link->killed = false;
+    link->kill_failed = false;
+
+    Dmod_EnterCritical();
+    if(process->dying)
+    {
+        Dmod_ExitCritical();
+        DMOD_LOG_ERROR("Cannot attach thread to process %s while it is being destroyed\n", process->name);
+        link->process = NULL;
+        return -EINVAL;
+    }
+    link->next = process->threads;
+    if(process->threads)
+    {
+        process->threads->prev = link;
+    }
+    process->threads = link;
+    process->thread_count++;
+    atomic_store_explicit(&thread_registry_active, true, memory_order_relaxed);
+    int priority = process->priority;
+    uint32_t affinity = process->affinity;
+    dmosi_process_sched_handler_t handler = sched_handler;
+    Dmod_ExitCritical();
+
+    // New threads inherit the scheduling attributes of their process
+    if(handler && (priority != DMOSI_PROCESS_PRIORITY_UNSET || affinity != DMOSI_PROCESS_AFFINITY_ANY)
+    && handler(thread, priority, affinity) != 0)
+    {
+        DMOD_LOG_WARN("Failed to apply scheduling attributes of process %s to a new thread\n", process->name);
+    }
+    return 0;
+}
+
+void dmosi_process_detach_thread( dmosi_process_thread_link_t* link )
+{
+    if(!link)
+        return;
+
+    Dmod_EnterCritical();
+    dmosi_process_t process = link->process;
+    if(process)
+    {
+        if(link->prev)
+            link->prev->next = link->next;
+        else
+            process->threads = link->next;
+        if(link->next)
+            link->next->prev = link->prev;
+        process->thread_count--;
+        link->process = NULL;
+    }
+    Dmod_ExitCritical();
+}
+
+size_t dmosi_process_get_thread_count( dmosi_process_t process )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to get thread count\n");
+        return 0;
+    }
+    if(!atomic_load_explicit(&thread_registry_active, memory_order_relaxed))
+        return dmosi_thread_get_by_process(process, NULL, 0);
+    return process->thread_count;
+}
+
+/**
+ * @brief Collect the live threads of a process
+ *
+ * Fills the on-stack buffer when the threads fit into it and allocates a
+ * larger array otherwise; the caller frees *threads if it differs from
+ * buffer.
+ *
+ * @param process Process whose threads to collect
+ * @param buffer Buffer of KILL_BATCH_SIZE handles
+ * @param threads Receives the array holding the handles
+ * @return size_t Number of handles collected
+ */
+static size_t collect_threads( dmosi_process_t process, dmosi_thread_t* buffer, dmosi_thread_t** threads )
+{
+    *threads = buffer;
+    size_t capacity = KILL_BATCH_SIZE;
+
+    if(!atomic_load_explicit(&thread_registry_active, memory_order_relaxed))
+    {
+        size_t count = dmosi_thread_get_by_process(process, NULL, 0);
+        if(count > capacity)
+        {
+            *threads = Dmod_Malloc(sizeof(dmosi_thread_t) * count);
+            if(!*threads)
+            {
+                *threads = buffer;
+                return 0;
+            }
+            capacity = count;
+        }
+        count = dmosi_thread_get_by_process(process, *threads, capacity);
+        return count < capacity ? count : capacity;
+    }
+
+    for(;;)
+    {
+        size_t count = 0;
+        Dmod_EnterCritical();
+        if(process->thread_count <= capacity)
+        {
+            for(dmosi_process_thread_link_t* link = process->threads; link; link = link->next)
+            {
+                if(!link->killed)
+                    (*threads)[count++] = link->thread;
+            }
+            Dmod_ExitCritical();
+            return count;
+        }
+        size_t needed = process->thread_count;
+        Dmod_ExitCritical();
+
+        if(*threads != buffer)
+            Dmod_Free(*threads);
+        *threads = Dmod_Malloc(sizeof(dmosi_thread_t) * needed);
+        if(!*threads)
+        {
+            *threads = buffer;
+            return 0;
+        }
+        capacity = needed;
+    }
+}
+
+/**
+ * @brief Re-apply the scheduling attributes of a process to all its threads
+ *
+ * @param process Process handle
+ * @return int 0 on success, -EFAULT if the handler failed for a thread
+ */
+static int apply_sched( dmosi_process_t process )
+{
+    dmosi_process_sched_handler_t handler = sched_handler;
+    if(!handler)
+        return 0;
+
+    dmosi_thread_t buffer[KILL_BATCH_SIZE];
+    dmosi_thread_t* threads;
+    size_t count = collect_threads(process, buffer, &threads);
+
+    int result = 0;
+    for(size_t i = 0; i < count; i++)
     {
-        DMOD_LOG_ERROR("Failed to allocate memory for process %s of module %s\n", name, module_name);
-        return NULL;
+        if(handler(threads[i], process->priority, process->affinity) != 0)
+        {
+            DMOD_LOG_ERROR("Failed to apply scheduling attributes to a thread of process %s\n", process->name);
+            result = -EFAULT;
+        }
     }
-
-    process->magic = MAGIC_NUMBER;
-    process->exit_status = 0;
-    process->state = DMOSI_PROCESS_STATE_RUNNING;
-    process->name = Dmod_StrDup(name);
-    process->pid = generate_process_id();
-    process->uid = 0;
-    process->pwd = NULL;
-    if(!process->name)
+    if(threads != buffer)
     {
-        DMOD_LOG_ERROR("Failed to duplicate process name %s for module %s\n", name, module_name);
-        Dmod_Free(process);
-        return NULL;
+        Dmod_Free(threads);
     }
-    process->parent = parent;
-    strcpy(process->module_name, module_name);
+    return result;
+}
 
-    DMOD_LOG_VERBOSE("Created process %s of module %s\n", name, module_name);
-    return process;
+void dmosi_process_set_sched_handler( dmosi_process_sched_handler_t handler )
+{
+    Dmod_EnterCritical();
+    sched_handler = handler;
+    Dmod_ExitCritical();
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _process_destroy, (dmosi_process_t process) )
+int dmosi_process_set_sched( dmosi_process_t process, int priority, uint32_t affinity )
 {
-    if(!process)
+    if(!validate_process(process))
     {
-        DMOD_LOG_ERROR("Cannot destroy NULL process\n");
-        return;
+        DMOD_LOG_ERROR("Invalid process handle provided to set scheduling attributes\n");
+        return -EINVAL;
     }
-    DMOD_LOG_VERBOSE("Destroying process %s of module %s\n", process->name, process->module_name);
 
     Dmod_EnterCritical();
+    process->priority = priority;
+    process->affinity = affinity;
+    Dmod_ExitCritical();
+
+    DMOD_LOG_VERBOSE("Process %s of module %s has priority %d and affinity 0x%x\n", process->name, process->module->name, priority, affinity);
+    return apply_sched(process);
+}
 
-    if(!kill_threads(process, process->exit_status))
+int dmosi_process_set_priority( dmosi_process_t process, int priority )
+{
+    if(!validate_process(process))
     {
-        DMOD_LOG_ERROR("Failed to kill threads while destroying process %s of module %s\n", process->name, process->module_name);
+        DMOD_LOG_ERROR("Invalid process handle provided to set priority\n");
+        return -EINVAL;
     }
+    return dmosi_process_set_sched(process, priority, process->affinity);
+}
 
-    process->state = DMOSI_PROCESS_STATE_TERMINATED;
-    process->magic = 0; // Invalidate the process handle
+int dmosi_process_set_affinity( dmosi_process_t process, uint32_t affinity )
+{
+    if(!validate_process(process))
+    {
+        DMOD_LOG_ERROR("Invalid process handle provided to set affinity\n");
+        return -EINVAL;
+    }
+    return dmosi_process_set_sched(process, process->priority, affinity);
+}
 
-    Dmod_Free(process->name);
-    Dmod_Free(process->pwd);
-    Dmod_Free(process);
+int dmosi_process_get_priority( dmosi_process_t process )
+{
+    GETTER_CHECK(validate_process(process), DMOSI_PROCESS_PRIORITY_UNSET, "Invalid process handle provided to get priority\n");
+    return process->priority;
+}
 
-    Dmod_ExitCritical();
+uint32_t dmosi_process_get_affinity( dmosi_process_t process )
+{
+    GETTER_CHECK(validate_process(process), DMOSI_PROCESS_AFFINITY_ANY, "Invalid process handle provided to get affinity\n");
+    return process->affinity;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_kill, (dmosi_process_t process, int status) )
+int dmosi_process_destroy_deferred( dmosi_process_t process )
 {
-    if(!process)
+    if(!validate_process(process))
     {
-        DMOD_LOG_ERROR("Cannot kill NULL process\n");
+        DMOD_LOG_ERROR("Invalid process handle provided to destroy deferred\n");
         return -EINVAL;
     }
-    DMOD_LOG_VERBOSE("Killing process %s of module %s with status %d\n", process->name, process->module_name, status);
-
-    if(!kill_threads(process, status))
+    if(!reap_enqueue(process))
     {
-        DMOD_LOG_ERROR("Failed to kill threads while killing process %s of module %s\n", process->name, process->module_name);
-        return -EFAULT;
+        DMOD_LOG_WARN("Process %s of module %s is already queued for destruction\n", process->name, process->module->name);
+        return -EALREADY;
     }
-
-    process->exit_status = status;
-    process->state = DMOSI_PROCESS_STATE_TERMINATED;
-    
+    DMOD_LOG_VERBOSE("Queued process %s of module %s for destruction\n", process->name, process->module->name);
     return 0;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_wait, (dmosi_process_t process, int32_t timeout_ms) )
+int dmosi_process_set_auto_reap( dmosi_process_t process, bool enable )
 {
-    if(!process)
+    if(!validate_process(process))
     {
-        DMOD_LOG_ERROR("Cannot wait for NULL process\n");
+        DMOD_LOG_ERROR("Invalid process handle provided to set auto reap\n");
         return -EINVAL;
     }
-    DMOD_LOG_VERBOSE("Waiting for process %s of module %s to terminate with timeout %d ms\n", process->name, process->module_name, timeout_ms);
 
-    int elapsed = 0;
-    const int poll_interval = 100; // Poll every 100 ms
+    Dmod_EnterCritical();
+    process->auto_reap = enable;
+    bool terminated = load_state(process) == DMOSI_PROCESS_STATE_TERMINATED;
+    Dmod_ExitCritical();
 
-    while(process->state != DMOSI_PROCESS_STATE_TERMINATED)
+    if(enable && terminated)
     {
-        if(timeout_ms >= 0 && elapsed >= timeout_ms)
-        {
-            DMOD_LOG_WARN("Timeout while waiting for process %s of module %s to terminate\n", process->name, process->module_name);
-            return -ETIMEDOUT;
-        }
-        dmosi_thread_sleep(poll_interval);
-        elapsed += poll_interval;
+        reap_enqueue(process);
     }
-
-    DMOD_LOG_VERBOSE("Process %s of module %s has terminated with exit status %d\n", process->name, process->module_name, process->exit_status);
-
     return 0;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_current,   (void) )
+size_t dmosi_process_reap( size_t max_count )
 {
-    if(!dmosi_is_started())
-    {
-        return NULL;
-    }
-    dmosi_thread_t current_thread = dmosi_thread_current();
-    if(!current_thread)
+    if(max_count == 0)
+        return 0;
+
+    // Take the whole queue at once, so concurrent pushes never race with the pops
+    dmosi_process_t queue = atomic_exchange_explicit(&reap_queue, NULL, memory_order_acquire);
+    size_t reaped = 0;
+    while(queue && reaped < max_count)
     {
-        DMOD_LOG_ERROR("Failed to get current thread while retrieving current process\n");
-        return NULL;
+        dmosi_process_t process = queue;
+        queue = process->reap_next;
+        dmosi_process_destroy(process);
+        reaped++;
     }
-    dmosi_process_t process = dmosi_thread_get_process(current_thread);
-    if(!process)
+
+    if(queue)
     {
-        DMOD_LOG_ERROR("Current thread does not belong to any process\n");
-        return NULL;
+        dmosi_process_t last = queue;
+        while(last->reap_next)
+        {
+            last = last->reap_next;
+        }
+        reap_push(queue, last);
     }
-    return process;
+    return reaped;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_get_exit_status, (dmosi_process_t process) )
+void dmosi_process_reaper_thread( void* arg )
 {
-    if(!process)
+    (void)arg;
+
+    Dmod_EnterCritical();
+    if(!reaper_wakeup)
     {
-        DMOD_LOG_ERROR("Cannot get exit status of NULL process\n");
-        return -EINVAL;
+        reaper_wakeup = dmosi_semaphore_create(0, DONE_SEMAPHORE_MAX_COUNT);
+    }
+    dmosi_semaphore_t wakeup = reaper_wakeup;
+    Dmod_ExitCritical();
+    if(!wakeup)
+    {
+        DMOD_LOG_WARN("No wakeup semaphore for the process reaper, polling instead\n");
     }
-    return process->exit_status;
-}
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_state_t, _process_get_state, (dmosi_process_t process) )
-{
-    if(!process)
+    for(;;)
     {
-        DMOD_LOG_ERROR("Cannot get state of NULL process\n");
-        return -EINVAL;
+        if(wakeup)
+        {
+            dmosi_semaphore_wait(wakeup, -1);
+        }
+        else
+        {
+            dmosi_thread_sleep(WAIT_POLL_INTERVAL_MS);
+        }
+        while(dmosi_process_reap(DMOSI_PROC_REAP_BATCH_SIZE) == DMOSI_PROC_REAP_BATCH_SIZE)
+        {
+            // Keep going while full batches come out of the queue
+        }
     }
-    return process->state;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_id_t, _process_get_id, (dmosi_process_t process) )
+/**
+ * @brief Raise the peak usage of a process to a new allocation total
+ */
+static void update_peak( dmosi_process_t process, size_t allocated )
 {
-    if(!process)
+    size_t peak = atomic_load_explicit(&process->peak_bytes, memory_order_relaxed);
+    while(allocated > peak &&
+          !atomic_compare_exchange_weak_explicit(&process->peak_bytes, &peak, allocated, memory_order_relaxed, memory_order_relaxed))
     {
-        DMOD_LOG_ERROR("Cannot get ID of NULL process\n");
-        return 0;
+        // peak has been reloaded by the failed exchange
     }
-    return process->pid;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _process_get_name, (dmosi_process_t process) )
+void dmosi_process_account_alloc( dmosi_process_t process, size_t size )
 {
-    if(!process)
-    {
-        DMOD_LOG_ERROR("Cannot get name of NULL process\n");
-        return NULL;
-    }
-    return process->name;
+    if(!validate_process(process))
+        return;
+
+    size_t allocated = atomic_fetch_add_explicit(&process->allocated_bytes, size, memory_order_relaxed) + size;
+    update_peak(process, allocated);
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _process_get_module_name, (dmosi_process_t process) )
+int dmosi_process_reserve_memory( dmosi_process_t process, size_t size )
 {
-    if(!process)
+    if(!validate_process(process))
+        return -EINVAL;
+
+    size_t limit = atomic_load_explicit(&process->memory_limit, memory_order_relaxed);
+    size_t allocated = atomic_load_explicit(&process->allocated_bytes, memory_order_relaxed);
+    size_t reserved;
+    do
     {
-        DMOD_LOG_ERROR("Cannot get module name of NULL process\n");
-        return NULL;
-    }
-    return process->module_name;
+        reserved = allocated + size;
+        if(limit != 0 && (reserved < allocated || reserved > limit))
+        {
+            DMOD_LOG_WARN("Allocation of %zu bytes exceeds the memory quota of process %s\n", size, process->name);
+            return -ENOMEM;
+        }
+    } while(!atomic_compare_exchange_weak_explicit(&process->allocated_bytes, &allocated, reserved, memory_order_relaxed, memory_order_relaxed));
+
+    update_peak(process, reserved);
+    return 0;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int,            _process_set_uid,   (dmosi_process_t process, dmosi_user_id_t uid) )
+int dmosi_process_set_memory_limit( dmosi_process_t process, size_t limit )
 {
     if(!validate_process(process))
     {
-        DMOD_LOG_ERROR("Invalid process handle provided to set UID\n");
+        DMOD_LOG_ERROR("Invalid process handle provided to set memory limit\n");
         return -EINVAL;
     }
-    process->uid = uid;
+    atomic_store_explicit(&process->memory_limit, limit, memory_order_relaxed);
+    DMOD_LOG_VERBOSE("Memory limit of process %s of module %s set to %zu bytes\n", process->name, process->module->name, limit);
     return 0;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_user_id_t, _process_get_uid,   (dmosi_process_t process) )
+void dmosi_process_account_free( dmosi_process_t process, size_t size )
 {
     if(!validate_process(process))
-    {
-        DMOD_LOG_ERROR("Invalid process handle provided to get UID\n");
-        return 0;
-    }
-    return process->uid;
+        return;
+
+    atomic_fetch_sub_explicit(&process->allocated_bytes, size, memory_order_relaxed);
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_get_parent, (dmosi_process_t process) )
+void dmosi_process_account_cpu( dmosi_process_t process, uint32_t ticks )
 {
-    if(!process)
-    {
-        DMOD_LOG_ERROR("Cannot get parent of NULL process\n");
-        return NULL;
-    }
-    return process->parent;
+    if(!validate_process(process))
+        return;
+
+    Dmod_EnterCritical();
+    process->cpu_ticks += ticks;
+    Dmod_ExitCritical();
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_id, (dmosi_process_t process, dmosi_process_id_t pid) )
+int dmosi_process_get_usage( dmosi_process_t process, dmosi_process_usage_t* usage )
 {
     if(!validate_process(process))
     {
-        DMOD_LOG_ERROR("Invalid process handle provided to set process ID\n");
+        DMOD_LOG_ERROR("Invalid process handle provided to get resource usage\n");
         return -EINVAL;
     }
-    DMOD_LOG_VERBOSE("Setting process ID of %s to %u\n", process->name, pid);
-    process->pid = pid;
+    if(!usage)
+    {
+        DMOD_LOG_ERROR("Resource usage buffer cannot be NULL\n");
+        return -EINVAL;
+    }
+
+    usage->allocated_bytes = atomic_load_explicit(&process->allocated_bytes, memory_order_relaxed);
+    usage->peak_bytes = atomic_load_explicit(&process->peak_bytes, memory_order_relaxed);
+    usage->memory_limit = atomic_load_explicit(&process->memory_limit, memory_order_relaxed);
+    usage->thread_count = dmosi_process_get_thread_count(process);
+
+    Dmod_EnterCritical();
+    usage->cpu_ticks = process->cpu_ticks;
+    Dmod_ExitCritical();
+
     return 0;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_module_name, (dmosi_process_t process, const char* module_name) )
+static int compare_owners( const void* a, const void* b )
 {
-    if(!validate_process(process))
+    uintptr_t x = *(const uintptr_t*)a;
+    uintptr_t y = *(const uintptr_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Count the threads of a process in a sorted array of thread owners
+ */
+static size_t count_owned( const uintptr_t* owners, size_t count, dmosi_process_t process )
+{
+    uintptr_t key = (uintptr_t)process;
+    size_t low = 0;
+    size_t high = count;
+    while(low < high)
     {
-        DMOD_LOG_ERROR("Invalid process handle provided to set module name\n");
-        return -EINVAL;
+        size_t middle = low + (high - low) / 2;
+        if(owners[middle] < key)
+            low = middle + 1;
+        else
+            high = middle;
     }
-    if(!module_name)
+    size_t end = low;
+    while(end < count && owners[end] == key)
     {
-        DMOD_LOG_ERROR("Module name cannot be NULL\n");
-        return -EINVAL;
+        end++;
     }
-    if(strlen(module_name) >= DMOD_MAX_MODULE_NAME_LENGTH)
+    return end - low;
+}
+
+/**
+ * @brief Fetch the owning processes of all threads, sorted
+ *
+ * Used when the thread layer does not attach threads, so that thread
+ * counts can be exported without calling into the thread layer per
+ * process. The thread layer is only called outside the critical section.
+ *
+ * @param count Receives the number of owners
+ * @return uintptr_t* Sorted owner pointers (NULL if there are no threads or on allocation failure)
+ */
+static uintptr_t* collect_thread_owners( size_t* count )
+{
+    *count = 0;
+    size_t total = dmosi_thread_get_all(NULL, 0);
+    if(total == 0)
+        return NULL;
+
+    dmosi_thread_t* threads = Dmod_Malloc(sizeof(dmosi_thread_t) * total);
+    uintptr_t* owners = Dmod_Malloc(sizeof(uintptr_t) * total);
+    if(!threads || !owners)
     {
-        DMOD_LOG_ERROR("Module name too long: %s\n", module_name);
-        return -EINVAL;
+        DMOD_LOG_WARN("Failed to allocate memory for thread owners, exporting stats without thread counts\n");
+        Dmod_Free(threads);
+        Dmod_Free(owners);
+        return NULL;
     }
-    DMOD_LOG_VERBOSE("Setting module name of process %s to %s\n", process->name, module_name);
-    strcpy(process->module_name, module_name);
-    return 0;
+    total = dmosi_thread_get_all(threads, total);
+    for(size_t i = 0; i < total; i++)
+    {
+        owners[i] = (uintptr_t)dmosi_thread_get_process(threads[i]);
+    }
+    Dmod_Free(threads);
+
+    qsort(owners, total, sizeof(uintptr_t), compare_owners);
+    *count = total;
+    return owners;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_pwd, (dmosi_process_t process, const char* pwd) )
+size_t dmosi_process_export_stats( dmosi_process_stats_t* stats, size_t max_count )
 {
-    if(!validate_process(process))
+    if(!stats)
     {
-        DMOD_LOG_ERROR("Invalid process handle provided to set working directory\n");
-        return -EINVAL;
+        Dmod_EnterCritical();
+        size_t count = pid_index.count;
+        Dmod_ExitCritical();
+        return count;
     }
-    if(!pwd)
+
+    size_t owner_count = 0;
+    uintptr_t* owners = NULL;
+    bool attached = atomic_load_explicit(&thread_registry_active, memory_order_relaxed);
+    if(!attached)
     {
-        DMOD_LOG_ERROR("Working directory cannot be NULL\n");
-        return -EINVAL;
+        owners = collect_thread_owners(&owner_count);
     }
-    DMOD_LOG_VERBOSE("Setting working directory of process %s to %s\n", process->name, pwd);
-    
-    // Free existing pwd if any
-    if(process->pwd)
+
+    size_t count = 0;
+    Dmod_EnterCritical();
+    for(size_t slot = 0; slot < pid_index.capacity && count < max_count; slot++)
     {
-        Dmod_Free(process->pwd);
+        dmosi_process_t process = pid_index.slots[slot];
+        if(!process)
+            continue;
+
+        dmosi_process_stats_t* record = &stats[count++];
+        record->cpu_ticks       = process->cpu_ticks;
+        record->allocated_bytes = atomic_load_explicit(&process->allocated_bytes, memory_order_relaxed);
+        record->peak_bytes      = atomic_load_explicit(&process->peak_bytes, memory_order_relaxed);
+        record->pid             = process->pid;
+        record->parent_pid      = process->parent ? process->parent->pid : 0;
+        record->group           = process->group;
+        record->uid             = process->uid;
+        record->module          = process->module->id;
+        record->thread_count    = (uint32_t)(attached ? process->thread_count : count_owned(owners, owner_count, process));
+        record->exit_status     = load_exit_status(process);
+        record->state           = (uint32_t)load_state(process);
+        strncpy(record->name, process->name, sizeof(record->name) - 1);
+        record->name[sizeof(record->name) - 1] = '\0';
     }
-    
-    // Allocate and copy new pwd
-    process->pwd = Dmod_StrDup(pwd);
-    if(!process->pwd)
+    Dmod_ExitCritical();
+
+    if(owners)
     {
-        DMOD_LOG_ERROR("Failed to allocate memory for working directory\n");
-        return -ENOMEM;
+        Dmod_Free(owners);
     }
-    
-    return 0;
+    return count;
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _process_get_pwd, (dmosi_process_t process) )
+void dmosi_process_trace_set_clock( dmosi_process_trace_clock_t clock )
 {
-    if(!validate_process(process))
-    {
-        DMOD_LOG_ERROR("Invalid process handle provided to get working directory\n");
-        return NULL;
-    }
-    
-    // Return stored pwd or default to root if not set
-    return process->pwd ? process->pwd : "/";
+#if DMOSI_PROC_TRACE_SIZE > 0
+    trace_clock = clock;
+#else
+    (void)clock;
+#endif
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _process_set_exit_status, (dmosi_process_t process, int exit_status) )
+#if DMOSI_PROC_TRACE_SIZE > 0
+/**
+ * @brief Copy a record out of the trace ring
+ *
+ * @param sequence Sequence number of the record
+ * @param record Filled with the record
+ * @return bool true if the record was complete and not overwritten while copying
+ */
+static bool trace_fetch( uint32_t sequence, dmosi_process_trace_record_t* record )
 {
-    if(!validate_process(process))
+    trace_slot_t* slot = &trace_ring[sequence & (DMOSI_PROC_TRACE_SIZE - 1)];
+    if(atomic_load_explicit(&slot->commit, memory_order_acquire) != sequence + 1)
+        return false; // Being written or already overwritten
+
+    *record = slot->record;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->commit, memory_order_relaxed) == sequence + 1;
+}
+
+/**
+ * @brief Get the sequence number of the oldest record still in the ring
+ */
+static uint32_t trace_oldest( uint32_t head )
+{
+    return head - (head < DMOSI_PROC_TRACE_SIZE ? head : DMOSI_PROC_TRACE_SIZE);
+}
+#endif
+
+size_t dmosi_process_trace_read( dmosi_process_trace_record_t* records, size_t max_count )
+{
+#if DMOSI_PROC_TRACE_SIZE > 0
+    if(!records)
+        return 0;
+
+    uint32_t head = atomic_load_explicit(&trace_head, memory_order_acquire);
+    size_t count = 0;
+    for(uint32_t sequence = trace_oldest(head); sequence != head && count < max_count; sequence++)
     {
-        DMOD_LOG_ERROR("Invalid process handle provided to set exit status\n");
-        return -EINVAL;
+        if(trace_fetch(sequence, &records[count]))
+        {
+            count++;
+        }
     }
-    DMOD_LOG_VERBOSE("Setting exit status of process %s to %d\n", process->name, exit_status);
-    process->exit_status = exit_status;
+    return count;
+#else
+    (void)records;
+    (void)max_count;
     return 0;
+#endif
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_find_by_name, (const char* name) )
+/**
+ * @brief Get a printable name of a trace event
+ */
+static const char* trace_event_name( uint8_t event )
 {
-    if(!name)
+    switch(event)
     {
-        DMOD_LOG_ERROR("Process name cannot be NULL\n");
-        return NULL;
+        case DMOSI_PROCESS_TRACE_CREATE:     return "create";
+        case DMOSI_PROCESS_TRACE_KILL:       return "kill";
+        case DMOSI_PROCESS_TRACE_DESTROY:    return "destroy";
+        case DMOSI_PROCESS_TRACE_WAIT_ENTER: return "wait-enter";
+        case DMOSI_PROCESS_TRACE_WAIT_EXIT:  return "wait-exit";
+        case DMOSI_PROCESS_TRACE_FIND:       return "find";
+        default:                             return "unknown";
     }
-    
-    return find_process_with_predicate(process_name_predicate, (void*)name, name);
 }
 
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _process_find_by_id, (dmosi_process_id_t pid) )
+void dmosi_process_trace_dump( void )
 {
-    if(pid == 0)
+    size_t printed = 0;
+
+#if DMOSI_PROC_TRACE_SIZE > 0
+    // Fetch one record at a time so the dump needs no buffer
+    uint32_t head = atomic_load_explicit(&trace_head, memory_order_acquire);
+    for(uint32_t sequence = trace_oldest(head); sequence != head; sequence++)
     {
-        DMOD_LOG_ERROR("Process ID cannot be 0\n");
-        return NULL;
+        dmosi_process_trace_record_t record;
+        if(!trace_fetch(sequence, &record))
+            continue;
+
+        DMOD_LOG_INFO("[%u] %llu %s pid=%u arg=%d\n", (unsigned)record.sequence, (unsigned long long)record.timestamp,
+                      trace_event_name(record.event), (unsigned)record.pid, (int)record.arg);
+        printed++;
+    }
+#else
+    (void)trace_event_name;
+#endif
+    if(printed == 0)
+    {
+        DMOD_LOG_INFO("Process trace is empty\n");
     }
-    
-    char pid_str[32];
-    Dmod_SnPrintf(pid_str, sizeof(pid_str), "ID %u", pid);
-    return find_process_with_predicate(process_id_predicate, &pid, pid_str);
 }
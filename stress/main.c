@@ -0,0 +1,447 @@
+#define DMOD_ENABLE_REGISTRATION
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "dmod.h"
+#include "dmosi.h"
+#include "dmosi_proc.h"
+
+// Default number of threads creating and destroying processes
+#define DEFAULT_CREATORS        4
+
+// Default number of create/destroy cycles per creator thread
+#define DEFAULT_ITERATIONS      20000
+
+// Number of processes each creator keeps alive at once
+#define LIVE_WINDOW             512
+
+// Number of threads doing lookups and enumerations while processes churn
+#define LOOKUP_THREADS          2
+
+// Number of threads waiting on processes that are about to be killed
+#define WAITER_THREADS          2
+
+// Every n-th process of a creator is offered to the waiter threads
+#define PUBLISH_INTERVAL        16
+
+// Largest PID tracked by the duplicate detector
+#define PID_LIMIT               65536
+
+// Most latency samples kept per thread
+#define MAX_SAMPLES             (1u << 20)
+
+/**
+ * @brief Latency samples of one operation collected by one thread
+ */
+typedef struct
+{
+    uint32_t* samples;
+    size_t count;
+} latency_t;
+
+/**
+ * @brief Process offered by a creator for waiter threads to wait on
+ */
+typedef struct
+{
+    pthread_mutex_t lock;
+    dmosi_process_t process;
+    int users;                      /**< Waiters currently inside dmosi_process_wait */
+    _Atomic uint64_t killed_ns;     /**< Time at which the creator killed the process */
+} slot_t;
+
+typedef struct
+{
+    size_t index;
+    size_t iterations;
+    latency_t create;
+    latency_t destroy;
+} creator_t;
+
+typedef struct
+{
+    uint32_t seed;
+    size_t operations;
+    latency_t find;
+} lookup_t;
+
+typedef struct
+{
+    uint32_t seed;
+    size_t wakeups;
+    latency_t wakeup;
+} waiter_t;
+
+static _Atomic uint8_t pid_live[PID_LIMIT];
+static _Atomic size_t failures;
+static _Atomic bool stop;
+static slot_t* slots;
+static size_t slot_count;
+
+/**
+ * @brief Get a monotonic timestamp in nanoseconds
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_random(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static bool latency_init(latency_t* latency, size_t capacity)
+{
+    latency->count = 0;
+    latency->samples = malloc(sizeof(uint32_t) * (capacity < MAX_SAMPLES ? capacity : MAX_SAMPLES));
+    return latency->samples != NULL;
+}
+
+static void latency_add(latency_t* latency, uint64_t start_ns)
+{
+    if(latency->count < MAX_SAMPLES)
+    {
+        uint64_t elapsed = now_ns() - start_ns;
+        latency->samples[latency->count++] = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+    }
+}
+
+static void fail(const char* message, dmosi_process_id_t pid)
+{
+    atomic_fetch_add(&failures, 1);
+    printf("FAILURE: %s (pid %u)\n", message, (unsigned)pid);
+}
+
+static int compare_samples(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Merge the samples of several threads and print throughput and percentiles
+ */
+static void report(const char* name, latency_t* latencies, size_t count, size_t stride, uint64_t wall_ns)
+{
+    size_t total = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        total += ((latency_t*)((char*)latencies + i * stride))->count;
+    }
+    if(total == 0)
+    {
+        printf("%-10s %10s\n", name, "no samples");
+        return;
+    }
+
+    uint32_t* merged = malloc(sizeof(uint32_t) * total);
+    if(!merged)
+        return;
+    size_t offset = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        latency_t* latency = (latency_t*)((char*)latencies + i * stride);
+        memcpy(&merged[offset], latency->samples, sizeof(uint32_t) * latency->count);
+        offset += latency->count;
+    }
+    qsort(merged, total, sizeof(uint32_t), compare_samples);
+
+    printf("%-10s %10zu ops %12.0f ops/s   p50 %8u ns   p99 %8u ns   max %10u ns\n", name, total,
+           (double)total * 1e9 / (double)wall_ns, merged[total / 2], merged[(total * 99) / 100], merged[total - 1]);
+    free(merged);
+}
+
+/**
+ * @brief Check a freshly created process through the getters and both indexes
+ */
+static void check_created(dmosi_process_t process, const char* name)
+{
+    dmosi_process_id_t pid = dmosi_process_get_id(process);
+    if(pid == 0 || pid >= PID_LIMIT)
+    {
+        fail("process has an invalid PID", pid);
+        return;
+    }
+    if(atomic_exchange(&pid_live[pid], 1) != 0)
+    {
+        fail("PID handed out twice", pid);
+    }
+    if(dmosi_process_find_by_id(pid) != process)
+    {
+        fail("process not found by its PID", pid);
+    }
+    if(strcmp(dmosi_process_get_name(process), name) != 0 || dmosi_process_find_by_name(name) != process)
+    {
+        fail("process not found by its name", pid);
+    }
+}
+
+/**
+ * @brief Kill and destroy a process, taking it back from the waiters first
+ */
+static void retire(creator_t* creator, slot_t* slot, dmosi_process_t process)
+{
+    dmosi_process_id_t pid = dmosi_process_get_id(process);
+
+    bool published = false;
+    pthread_mutex_lock(&slot->lock);
+    if(slot->process == process)
+    {
+        published = true;
+        atomic_store(&slot->killed_ns, now_ns());
+        dmosi_process_kill(process, 0);
+        slot->process = NULL;
+    }
+    while(published && slot->users > 0)
+    {
+        // Waiters hold the handle until their wait returns
+        pthread_mutex_unlock(&slot->lock);
+        sched_yield();
+        pthread_mutex_lock(&slot->lock);
+    }
+    pthread_mutex_unlock(&slot->lock);
+
+    // Cleared before destroy, since the PID may be reused as soon as destroy frees it
+    if(pid < PID_LIMIT)
+    {
+        atomic_store(&pid_live[pid], 0);
+    }
+
+    uint64_t start = now_ns();
+    dmosi_process_destroy(process);
+    latency_add(&creator->destroy, start);
+}
+
+static void* creator_thread(void* arg)
+{
+    creator_t* creator = arg;
+    slot_t* slot = &slots[creator->index];
+    dmosi_process_t live[LIVE_WINDOW];
+    size_t live_count = 0;
+    char name[32];
+
+    for(size_t i = 0; i < creator->iterations; i++)
+    {
+        snprintf(name, sizeof(name), "stress_%zu_%zu", creator->index, i);
+
+        uint64_t start = now_ns();
+        dmosi_process_t process = dmosi_process_create(name, "stress_module", NULL);
+        latency_add(&creator->create, start);
+        if(!process)
+        {
+            fail("create failed", 0);
+            continue;
+        }
+        check_created(process, name);
+
+        if(i % PUBLISH_INTERVAL == 0)
+        {
+            pthread_mutex_lock(&slot->lock);
+            if(!slot->process)
+            {
+                slot->process = process;
+            }
+            pthread_mutex_unlock(&slot->lock);
+        }
+
+        if(live_count == LIVE_WINDOW)
+        {
+            size_t victim = i % LIVE_WINDOW;
+            retire(creator, slot, live[victim]);
+            live[victim] = process;
+        }
+        else
+        {
+            live[live_count++] = process;
+        }
+    }
+
+    for(size_t i = 0; i < live_count; i++)
+    {
+        retire(creator, slot, live[i]);
+    }
+    return NULL;
+}
+
+static void* lookup_thread(void* arg)
+{
+    lookup_t* lookup = arg;
+    while(!atomic_load(&stop))
+    {
+        // Returned handles may be destroyed at any time, so they are only counted
+        dmosi_process_id_t pid = 1 + next_random(&lookup->seed) % 4096;
+        uint64_t start = now_ns();
+        (void)dmosi_process_find_by_id(pid);
+        latency_add(&lookup->find, start);
+
+        if(next_random(&lookup->seed) % 64 == 0)
+        {
+            (void)dmosi_process_get_all(NULL, 0);
+        }
+        lookup->operations++;
+    }
+    return NULL;
+}
+
+static void* waiter_thread(void* arg)
+{
+    waiter_t* waiter = arg;
+    while(!atomic_load(&stop))
+    {
+        slot_t* slot = &slots[next_random(&waiter->seed) % slot_count];
+
+        pthread_mutex_lock(&slot->lock);
+        dmosi_process_t process = slot->process;
+        if(process)
+        {
+            slot->users++;
+        }
+        pthread_mutex_unlock(&slot->lock);
+        if(!process)
+        {
+            sched_yield();
+            continue;
+        }
+
+        int result = dmosi_process_wait(process, 1000);
+        if(result == 0)
+        {
+            latency_add(&waiter->wakeup, atomic_load(&slot->killed_ns));
+            waiter->wakeups++;
+        }
+
+        pthread_mutex_lock(&slot->lock);
+        slot->users--;
+        pthread_mutex_unlock(&slot->lock);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t creators = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_CREATORS;
+    size_t iterations = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_ITERATIONS;
+    if(creators == 0 || iterations == 0)
+    {
+        printf("usage: %s [creator threads] [iterations per thread]\n", argv[0]);
+        return 2;
+    }
+
+    printf("=== dmosi_proc stress: %zu creators x %zu cycles, %d live each, %d lookup and %d waiter threads ===\n",
+           creators, iterations, LIVE_WINDOW, LOOKUP_THREADS, WAITER_THREADS);
+
+    creator_t* creator = calloc(creators, sizeof(creator_t));
+    slots = calloc(creators, sizeof(slot_t));
+    pthread_t* creator_threads = calloc(creators, sizeof(pthread_t));
+    lookup_t lookup[LOOKUP_THREADS];
+    waiter_t waiter[WAITER_THREADS];
+    pthread_t lookup_threads[LOOKUP_THREADS];
+    pthread_t waiter_threads[WAITER_THREADS];
+    if(!creator || !slots || !creator_threads)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+    slot_count = creators;
+
+    bool ready = true;
+    for(size_t i = 0; i < creators; i++)
+    {
+        pthread_mutex_init(&slots[i].lock, NULL);
+        creator[i].index = i;
+        creator[i].iterations = iterations;
+        ready = ready && latency_init(&creator[i].create, iterations) && latency_init(&creator[i].destroy, iterations);
+    }
+    for(size_t i = 0; i < LOOKUP_THREADS; i++)
+    {
+        lookup[i] = (lookup_t){ .seed = 0x9E3779B9u + (uint32_t)i };
+        ready = ready && latency_init(&lookup[i].find, MAX_SAMPLES);
+    }
+    for(size_t i = 0; i < WAITER_THREADS; i++)
+    {
+        waiter[i] = (waiter_t){ .seed = 0x85EBCA6Bu + (uint32_t)i };
+        ready = ready && latency_init(&waiter[i].wakeup, MAX_SAMPLES);
+    }
+    if(!ready)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    uint64_t start = now_ns();
+    for(size_t i = 0; i < LOOKUP_THREADS; i++)
+    {
+        pthread_create(&lookup_threads[i], NULL, lookup_thread, &lookup[i]);
+    }
+    for(size_t i = 0; i < WAITER_THREADS; i++)
+    {
+        pthread_create(&waiter_threads[i], NULL, waiter_thread, &waiter[i]);
+    }
+    for(size_t i = 0; i < creators; i++)
+    {
+        pthread_create(&creator_threads[i], NULL, creator_thread, &creator[i]);
+    }
+    for(size_t i = 0; i < creators; i++)
+    {
+        pthread_join(creator_threads[i], NULL);
+    }
+    atomic_store(&stop, true);
+    for(size_t i = 0; i < LOOKUP_THREADS; i++)
+    {
+        pthread_join(lookup_threads[i], NULL);
+    }
+    for(size_t i = 0; i < WAITER_THREADS; i++)
+    {
+        pthread_join(waiter_threads[i], NULL);
+    }
+    uint64_t wall_ns = now_ns() - start;
+
+    report("create", &creator[0].create, creators, sizeof(creator_t), wall_ns);
+    report("destroy", &creator[0].destroy, creators, sizeof(creator_t), wall_ns);
+    report("find", &lookup[0].find, LOOKUP_THREADS, sizeof(lookup_t), wall_ns);
+    report("wakeup", &waiter[0].wakeup, WAITER_THREADS, sizeof(waiter_t), wall_ns);
+
+    size_t leaked = dmosi_process_get_all(NULL, 0);
+    if(leaked != 0)
+    {
+        printf("FAILURE: %zu processes left after all were destroyed\n", leaked);
+        atomic_fetch_add(&failures, 1);
+    }
+
+    for(size_t i = 0; i < creators; i++)
+    {
+        free(creator[i].create.samples);
+        free(creator[i].destroy.samples);
+        pthread_mutex_destroy(&slots[i].lock);
+    }
+    for(size_t i = 0; i < LOOKUP_THREADS; i++)
+    {
+        free(lookup[i].find.samples);
+    }
+    for(size_t i = 0; i < WAITER_THREADS; i++)
+    {
+        free(waiter[i].wakeup.samples);
+    }
+    free(creator_threads);
+    free(slots);
+    free(creator);
+
+    size_t failed = atomic_load(&failures);
+    printf("%s: %zu failures in %.2f s\n", failed ? "FAILED" : "PASSED", failed, (double)wall_ns / 1e9);
+    return failed ? 1 : 0;
+}
@@ -3,8 +3,12 @@
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <pthread.h>
 #include "dmod.h"
 #include "dmosi.h"
+#include "dmosi_proc.h"
 
 // Test result tracking
 static int tests_passed = 0;
@@ -170,9 +174,93 @@ void test_process_pwd(void)
     TEST_ASSERT(strcmp(dmosi_process_get_pwd(proc), "/tmp") == 0,
                 "Get process PWD returns '/tmp' after update");
 
+    // A PWD handed out to a reader survives the next update
+    const char* previous = dmosi_process_get_pwd(proc);
+    TEST_ASSERT(dmosi_process_set_pwd(proc, "/var") == 0,
+                "Update process PWD to '/var'");
+    TEST_ASSERT(strcmp(previous, "/tmp") == 0,
+                "Previously returned PWD is still readable after one update");
+
+    // Setting the retired PWD again reuses it
+    TEST_ASSERT(dmosi_process_set_pwd(proc, previous) == 0,
+                "Set process PWD back to previously returned string");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(proc), "/tmp") == 0,
+                "Get process PWD returns '/tmp' after switching back");
+
+    // A suffix of the retired string may be stored in that string's own buffer
+    TEST_ASSERT(dmosi_process_set_pwd(proc, "/srv/data") == 0, "Update process PWD to '/srv/data'");
+    const char* retired = dmosi_process_get_pwd(proc);
+    TEST_ASSERT(dmosi_process_set_pwd(proc, "/opt") == 0 && dmosi_process_set_pwd(proc, retired + 4) == 0
+             && strcmp(dmosi_process_get_pwd(proc), "/data") == 0,
+                "Set PWD to a suffix of the retired string");
+    TEST_ASSERT(dmosi_process_set_pwd(proc, "/tmp") == 0, "Restore process PWD to '/tmp'");
+
+    // Copying takes a snapshot that no later update can change
+    char copy[8] = "unset";
+    TEST_ASSERT(dmosi_process_copy_pwd(proc, copy, sizeof(copy)) == 0 && strcmp(copy, "/tmp") == 0,
+                "Copy PWD writes the current working directory");
+    TEST_ASSERT(dmosi_process_set_pwd(proc, "/var/log/dmosi") == 0
+             && dmosi_process_copy_pwd(proc, copy, sizeof(copy)) == -ERANGE && strcmp(copy, "/tmp") == 0,
+                "Copy PWD into a too small buffer returns -ERANGE and leaves the buffer unchanged");
+    TEST_ASSERT(dmosi_process_copy_pwd(NULL, copy, sizeof(copy)) == -EINVAL
+             && dmosi_process_copy_pwd(proc, NULL, 0) == -EINVAL,
+                "Copy PWD with invalid arguments returns -EINVAL");
+
     dmosi_process_destroy(proc);
 }
 
+// -----------------------------------------
+//
+//      Test: Working directory inheritance
+//
+// -----------------------------------------
+void test_process_pwd_inheritance(void)
+{
+    printf("\n=== Testing process working directory inheritance ===\n");
+
+    const char* long_pwd = "/home/user/projects/dmosi-proc/build/with/a/path/longer/than/any/inline/buffer";
+
+    dmosi_process_t parent = dmosi_process_create("pwd_parent", "test_module", NULL);
+    TEST_ASSERT(parent != NULL, "Create parent process for PWD inheritance test");
+    TEST_ASSERT(dmosi_process_set_pwd(parent, long_pwd) == 0, "Set parent PWD");
+
+    dmosi_process_t child = dmosi_process_create("pwd_child", "test_module", parent);
+    TEST_ASSERT(child != NULL, "Create child process");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(child), long_pwd) == 0,
+                "Child inherits parent PWD");
+
+    dmosi_process_t workers[2];
+    TEST_ASSERT(dmosi_process_create_many("pwd_worker", "test_module", parent, 2, workers) == 0,
+                "Create batch of children");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(workers[1]), long_pwd) == 0,
+                "Batch children inherit parent PWD");
+
+    // Copy on write: changing one process leaves the others untouched
+    TEST_ASSERT(dmosi_process_set_pwd(child, "/tmp") == 0, "Set child PWD");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(child), "/tmp") == 0,
+                "Child PWD changes");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(parent), long_pwd) == 0,
+                "Parent PWD is unaffected by child update");
+
+    TEST_ASSERT(dmosi_process_set_pwd(parent, "/srv") == 0, "Set parent PWD again");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(workers[0]), long_pwd) == 0,
+                "Children keep inherited PWD after parent update");
+
+    // Shared strings outlive the process that set them
+    dmosi_process_destroy(parent);
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(workers[0]), long_pwd) == 0,
+                "Inherited PWD survives destroying the parent");
+
+    dmosi_process_t orphan = dmosi_process_create("pwd_orphan", "test_module", NULL);
+    TEST_ASSERT(orphan != NULL && strcmp(dmosi_process_get_pwd(orphan), "/") == 0,
+                "Process without parent defaults to '/'");
+
+    dmosi_process_destroy(orphan);
+    dmosi_process_destroy(workers[0]);
+    dmosi_process_destroy(workers[1]);
+    dmosi_process_destroy(child);
+}
+
 // -----------------------------------------
 //
 //      Test: Process exit status
@@ -251,7 +339,118 @@ void test_process_module_name(void)
     TEST_ASSERT(strcmp(dmosi_process_get_module_name(proc), "new_module") == 0,
                 "Get process module name returns 'new_module'");
 
+    // Processes of the same module share one interned module name
+    dmosi_process_t peer = dmosi_process_create("module_peer", "new_module", NULL);
+    TEST_ASSERT(peer != NULL, "Create second process of the module");
+    TEST_ASSERT(dmosi_process_get_module_name(peer) == dmosi_process_get_module_name(proc),
+                "Processes of the same module share the module name");
+
     dmosi_process_destroy(proc);
+    TEST_ASSERT(strcmp(dmosi_process_get_module_name(peer), "new_module") == 0,
+                "Module name outlives the destroyed process of the module");
+    dmosi_process_destroy(peer);
+}
+
+// -----------------------------------------
+//
+//      Test: Module handles
+//
+// -----------------------------------------
+void test_process_module_handles(void)
+{
+    printf("\n=== Testing module handles ===\n");
+
+    TEST_ASSERT(dmosi_process_find_module("handle_module") == DMOSI_PROCESS_MODULE_INVALID,
+                "Find unknown module returns invalid handle");
+
+    dmosi_process_t first  = dmosi_process_create("handle_first", "handle_module", NULL);
+    dmosi_process_t second = dmosi_process_create("handle_second", "handle_module", NULL);
+    dmosi_process_t other  = dmosi_process_create("handle_other", "handle_other_module", NULL);
+    TEST_ASSERT(first != NULL && second != NULL && other != NULL, "Create processes for module handle test");
+
+    dmosi_process_module_t module = dmosi_process_find_module("handle_module");
+    TEST_ASSERT(module != DMOSI_PROCESS_MODULE_INVALID, "Find module returns valid handle");
+    TEST_ASSERT(dmosi_process_get_module(first) == module && dmosi_process_get_module(second) == module,
+                "Processes of the module share its handle");
+    TEST_ASSERT(dmosi_process_get_module(other) != module,
+                "Process of another module has a different handle");
+
+    dmosi_process_t found[4] = { NULL };
+    TEST_ASSERT(dmosi_process_get_by_module(module, NULL, 0) == 2,
+                "Get by module with NULL buffer returns process count");
+    size_t count = dmosi_process_get_by_module(module, found, 4);
+    TEST_ASSERT(count == 2 && ((found[0] == first && found[1] == second) || (found[0] == second && found[1] == first)),
+                "Get by module returns the processes of the module");
+    TEST_ASSERT(dmosi_process_get_by_module(module, found, 1) == 1,
+                "Get by module respects buffer capacity");
+
+    // Moving a process to another module updates both modules
+    TEST_ASSERT(dmosi_process_set_module_name(second, "handle_other_module") == 0,
+                "Move process to another module");
+    TEST_ASSERT(dmosi_process_get_module(second) == dmosi_process_get_module(other),
+                "Moved process takes the handle of its new module");
+    TEST_ASSERT(dmosi_process_get_by_module(module, NULL, 0) == 1,
+                "Old module counts one process less");
+
+    dmosi_process_destroy(first);
+    TEST_ASSERT(dmosi_process_find_module("handle_module") == module,
+                "Module keeps its handle after its last process is destroyed");
+    TEST_ASSERT(dmosi_process_get_by_module(module, found, 4) == 0,
+                "Get by module without processes returns no processes");
+
+    first = dmosi_process_create("handle_respawn", "handle_module", NULL);
+    TEST_ASSERT(dmosi_process_get_module(first) == module,
+                "Respawned process of the module gets the same handle");
+    dmosi_process_destroy(first);
+
+    dmosi_process_destroy(second);
+    dmosi_process_destroy(other);
+}
+
+// -----------------------------------------
+//
+//      Test: Kill all processes of a module
+//
+// -----------------------------------------
+void test_process_kill_module(void)
+{
+    printf("\n=== Testing kill module ===\n");
+
+    dmosi_process_t workers[3];
+    TEST_ASSERT(dmosi_process_create_many("unload_worker", "unload_module", NULL, 3, workers) == 0,
+                "Create processes of the module to unload");
+    dmosi_process_t bystander = dmosi_process_create("unload_bystander", "test_module", NULL);
+    TEST_ASSERT(bystander != NULL, "Create process of another module");
+
+    TEST_ASSERT(dmosi_process_kill(workers[0], 2) == 0, "Kill one process of the module first");
+
+    dmosi_process_module_t module = dmosi_process_find_module("unload_module");
+    TEST_ASSERT(dmosi_process_kill_module(module, 9) == 2,
+                "Kill module returns number of killed processes");
+    TEST_ASSERT(dmosi_process_get_exit_status(workers[0]) == 2,
+                "Kill module keeps the exit status of an already terminated process");
+
+    bool all_terminated = true;
+    for(int i = 1; i < 3; i++)
+    {
+        all_terminated = all_terminated
+                      && dmosi_process_get_state(workers[i]) == DMOSI_PROCESS_STATE_TERMINATED
+                      && dmosi_process_get_exit_status(workers[i]) == 9;
+    }
+    TEST_ASSERT(all_terminated, "Processes of the module are terminated with the given status");
+    TEST_ASSERT(dmosi_process_get_state(bystander) != DMOSI_PROCESS_STATE_TERMINATED,
+                "Process of another module keeps running");
+    TEST_ASSERT(dmosi_process_wait(workers[1], 0) == 0,
+                "Wait on killed process of the module returns immediately");
+
+    for(int i = 0; i < 3; i++)
+    {
+        dmosi_process_destroy(workers[i]);
+    }
+    TEST_ASSERT(dmosi_process_kill_module(module, 9) == 0,
+                "Kill module without processes returns 0");
+
+    dmosi_process_destroy(bystander);
 }
 
 // -----------------------------------------
@@ -312,9 +511,342 @@ void test_process_wait(void)
     TEST_ASSERT(dmosi_process_wait(proc2, 0) == -ETIMEDOUT,
                 "Wait with timeout=0 on running process returns -ETIMEDOUT");
 
+    // Blocking wait must honour the timeout and leave no stale waiter behind
+    TEST_ASSERT(dmosi_process_wait(proc2, 50) == -ETIMEDOUT,
+                "Wait with timeout=50 on running process returns -ETIMEDOUT");
+
+    dmosi_process_kill(proc2, 3);
+    TEST_ASSERT(dmosi_process_wait(proc2, 50) == 0,
+                "Wait after kill returns 0 following an earlier timeout");
+
     dmosi_process_destroy(proc2);
 }
 
+// -----------------------------------------
+//
+//      Test: Wait on several processes
+//
+// -----------------------------------------
+void test_process_wait_many(void)
+{
+    printf("\n=== Testing process wait any / wait all ===\n");
+
+    dmosi_process_t workers[3];
+    TEST_ASSERT(dmosi_process_create_many("wait_many", "test_module", NULL, 3, workers) == 0,
+                "Create processes for wait any / wait all test");
+
+    int exit_status = 0;
+    TEST_ASSERT(dmosi_process_wait_any(workers, 3, 0, &exit_status) == -ETIMEDOUT,
+                "Wait any with zero timeout on running processes returns -ETIMEDOUT");
+    TEST_ASSERT(dmosi_process_wait_any(workers, 3, 50, &exit_status) == -ETIMEDOUT,
+                "Wait any with 50 ms timeout on running processes returns -ETIMEDOUT");
+
+    dmosi_process_kill(workers[1], 17);
+    TEST_ASSERT(dmosi_process_wait_any(workers, 3, -1, &exit_status) == 1,
+                "Wait any returns index of the killed process");
+    TEST_ASSERT(exit_status == 17, "Wait any reports exit status of the killed process");
+
+    TEST_ASSERT(dmosi_process_wait_all(workers, 3, 0) == -ETIMEDOUT,
+                "Wait all with running processes returns -ETIMEDOUT");
+    dmosi_process_kill(workers[0], 0);
+    dmosi_process_kill(workers[2], 0);
+    TEST_ASSERT(dmosi_process_wait_all(workers, 3, -1) == 0,
+                "Wait all returns 0 once every process is killed");
+
+    dmosi_process_t invalid[2] = { workers[0], NULL };
+    TEST_ASSERT(dmosi_process_wait_any(invalid, 2, 0, NULL) == -EINVAL,
+                "Wait any with an invalid handle returns -EINVAL");
+    TEST_ASSERT(dmosi_process_wait_all(NULL, 2, 0) == -EINVAL,
+                "Wait all with NULL array returns -EINVAL");
+    TEST_ASSERT(dmosi_process_wait_any(workers, 0, 0, NULL) == -EINVAL,
+                "Wait any with empty set returns -EINVAL");
+
+    for(int i = 0; i < 3; i++)
+    {
+        dmosi_process_destroy(workers[i]);
+    }
+}
+
+// -----------------------------------------
+//
+//      Test: Termination callbacks
+//
+// -----------------------------------------
+typedef struct
+{
+    int calls;
+    int exit_status;
+    dmosi_process_t process;
+} exit_record_t;
+
+static void record_exit(dmosi_process_t process, int exit_status, void* context)
+{
+    exit_record_t* record = context;
+    record->calls++;
+    record->exit_status = exit_status;
+    record->process = process;
+}
+
+void test_process_exit_callbacks(void)
+{
+    printf("\n=== Testing process exit callbacks ===\n");
+
+    exit_record_t on_kill = { 0 };
+    exit_record_t on_destroy = { 0 };
+    exit_record_t removed = { 0 };
+    exit_record_t late = { 0 };
+
+    dmosi_process_t killed = dmosi_process_create("exit_cb_killed", "test_module", NULL);
+    dmosi_process_t destroyed = dmosi_process_create("exit_cb_destroyed", "test_module", NULL);
+    TEST_ASSERT(killed != NULL && destroyed != NULL, "Create processes for exit callback test");
+
+    TEST_ASSERT(dmosi_process_add_exit_callback(killed, record_exit, &on_kill) == 0,
+                "Add exit callback");
+    TEST_ASSERT(dmosi_process_add_exit_callback(killed, record_exit, &removed) == 0,
+                "Add second exit callback");
+    TEST_ASSERT(dmosi_process_remove_exit_callback(killed, record_exit, &removed) == 0,
+                "Remove pending exit callback");
+    TEST_ASSERT(dmosi_process_remove_exit_callback(killed, record_exit, &removed) == -ENOENT,
+                "Remove unknown exit callback returns -ENOENT");
+    TEST_ASSERT(on_kill.calls == 0, "Exit callback does not fire while process runs");
+
+    dmosi_process_kill(killed, 21);
+    TEST_ASSERT(on_kill.calls == 1 && on_kill.exit_status == 21 && on_kill.process == killed,
+                "Exit callback fires once on kill with exit status");
+    TEST_ASSERT(removed.calls == 0, "Removed exit callback does not fire");
+
+    dmosi_process_kill(killed, 22);
+    TEST_ASSERT(on_kill.calls == 1, "Exit callback does not fire again on second kill");
+
+    TEST_ASSERT(dmosi_process_add_exit_callback(killed, record_exit, &late) == 0 && late.calls == 1,
+                "Exit callback added after termination fires immediately");
+
+    dmosi_process_set_exit_status(destroyed, 4);
+    TEST_ASSERT(dmosi_process_add_exit_callback(destroyed, record_exit, &on_destroy) == 0,
+                "Add exit callback to process to destroy");
+    dmosi_process_destroy(destroyed);
+    TEST_ASSERT(on_destroy.calls == 1 && on_destroy.exit_status == 4 && on_destroy.process == destroyed,
+                "Exit callback fires on destroy with exit status");
+
+    TEST_ASSERT(dmosi_process_add_exit_callback(killed, NULL, NULL) == -EINVAL,
+                "Add NULL exit callback returns -EINVAL");
+    TEST_ASSERT(dmosi_process_add_exit_callback(NULL, record_exit, NULL) == -EINVAL,
+                "Add exit callback to NULL process returns -EINVAL");
+
+    dmosi_process_destroy(killed);
+    TEST_ASSERT(on_kill.calls == 1 && late.calls == 1,
+                "Destroying a killed process does not fire its callbacks again");
+}
+
+// -----------------------------------------
+//
+//      Test: Deferred destruction
+//
+// -----------------------------------------
+void test_process_reaper(void)
+{
+    printf("\n=== Testing deferred process destruction ===\n");
+
+    dmosi_process_t deferred[3];
+    TEST_ASSERT(dmosi_process_create_many("reap_deferred", "test_module", NULL, 3, deferred) == 0,
+                "Create processes to destroy deferred");
+    dmosi_process_id_t pid = dmosi_process_get_id(deferred[0]);
+
+    bool queued = true;
+    for(int i = 0; i < 3; i++)
+    {
+        queued = queued && dmosi_process_destroy_deferred(deferred[i]) == 0;
+    }
+    TEST_ASSERT(queued, "Queue processes for destruction");
+    TEST_ASSERT(dmosi_process_destroy_deferred(deferred[0]) == -EALREADY,
+                "Queue process twice returns -EALREADY");
+    TEST_ASSERT(dmosi_process_find_by_id(pid) == deferred[0],
+                "Queued process exists until it is reaped");
+
+    TEST_ASSERT(dmosi_process_reap(2) == 2, "Reap respects the batch size");
+    TEST_ASSERT(dmosi_process_reap(10) == 1, "Reap destroys the remaining process");
+    TEST_ASSERT(dmosi_process_reap(10) == 0, "Reap with empty queue returns 0");
+    TEST_ASSERT(dmosi_process_find_by_id(pid) == NULL, "Reaped process is gone");
+
+    // Auto reaping queues terminated processes and is inherited by children
+    dmosi_process_t parent = dmosi_process_create("reap_parent", "test_module", NULL);
+    TEST_ASSERT(dmosi_process_set_auto_reap(parent, true) == 0, "Enable auto reap");
+    dmosi_process_t child = dmosi_process_create("reap_child", "test_module", parent);
+    TEST_ASSERT(child != NULL, "Create child of auto-reaped process");
+    dmosi_process_id_t child_pid = dmosi_process_get_id(child);
+
+    dmosi_process_kill(child, 0);
+    dmosi_process_kill(parent, 0);
+    dmosi_process_kill(parent, 0);
+    TEST_ASSERT(dmosi_process_reap(10) == 2, "Killed auto-reaped processes are queued once");
+    TEST_ASSERT(dmosi_process_find_by_id(child_pid) == NULL, "Auto-reaped child is gone");
+
+    dmosi_process_t late = dmosi_process_create("reap_late", "test_module", NULL);
+    dmosi_process_kill(late, 0);
+    TEST_ASSERT(dmosi_process_set_auto_reap(late, true) == 0 && dmosi_process_reap(10) == 1,
+                "Enabling auto reap on a terminated process queues it");
+
+    TEST_ASSERT(dmosi_process_destroy_deferred(NULL) == -EINVAL,
+                "Destroy deferred NULL process returns -EINVAL");
+    TEST_ASSERT(dmosi_process_set_auto_reap(NULL, true) == -EINVAL,
+                "Set auto reap on NULL process returns -EINVAL");
+}
+
+// -----------------------------------------
+//
+//      Test: Killing an auto-reaped tree with a running reaper
+//
+// -----------------------------------------
+static _Atomic bool reaper_stop;
+
+static void* reaper_loop(void* arg)
+{
+    (void)arg;
+    while(!atomic_load(&reaper_stop))
+    {
+        if(dmosi_process_reap(4) == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Keeps kill tree busy on a child so the reaper gets to the killed root
+static void reaped_child_exit(dmosi_process_t process, int exit_status, void* context)
+{
+    (void)process;
+    (void)exit_status;
+    (void)context;
+    dmosi_thread_sleep(1);
+}
+
+void test_process_kill_tree_reaped(void)
+{
+    printf("\n=== Testing kill tree with a running reaper ===\n");
+
+    atomic_store(&reaper_stop, false);
+    pthread_t reaper;
+    TEST_ASSERT(pthread_create(&reaper, NULL, reaper_loop, NULL) == 0, "Start reaper thread");
+
+    bool killed = true;
+    bool reaped = true;
+    for(int round = 0; round < 20; round++)
+    {
+        dmosi_process_t root = dmosi_process_create("reaped_root", "test_module", NULL);
+        dmosi_process_set_auto_reap(root, true);
+        dmosi_process_id_t pids[13];
+        size_t count = 0;
+        pids[count++] = dmosi_process_get_id(root);
+        for(int i = 0; i < 3; i++)
+        {
+            dmosi_process_t child = dmosi_process_create("reaped_child", "test_module", root);
+            dmosi_process_add_exit_callback(child, reaped_child_exit, NULL);
+            pids[count++] = dmosi_process_get_id(child);
+            for(int j = 0; j < 3; j++)
+            {
+                pids[count++] = dmosi_process_get_id(dmosi_process_create("reaped_grandchild", "test_module", child));
+            }
+        }
+
+        killed = killed && dmosi_process_kill_tree(root, 3) == 0;
+
+        // Every process of the tree is destroyed by the reaper
+        for(size_t i = 0; i < count; i++)
+        {
+            for(int spin = 0; spin < 2000 && dmosi_process_find_by_id(pids[i]) != NULL; spin++)
+            {
+                dmosi_thread_sleep(1);
+            }
+            reaped = reaped && dmosi_process_find_by_id(pids[i]) == NULL;
+        }
+    }
+    atomic_store(&reaper_stop, true);
+    pthread_join(reaper, NULL);
+
+    TEST_ASSERT(killed, "Kill tree of auto-reaped processes returns 0");
+    TEST_ASSERT(reaped, "Reaper destroys every process of the killed tree");
+}
+
+// -----------------------------------------
+//
+//      Test: Process groups
+//
+// -----------------------------------------
+void test_process_groups(void)
+{
+    printf("\n=== Testing process groups ===\n");
+
+    dmosi_process_t leader = dmosi_process_create("group_leader", "test_module", NULL);
+    TEST_ASSERT(leader != NULL, "Create group leader");
+    dmosi_process_id_t group = dmosi_process_get_group(leader);
+    TEST_ASSERT(group == dmosi_process_get_id(leader), "Process without parent leads its own group");
+
+    dmosi_process_t members[2];
+    TEST_ASSERT(dmosi_process_create_many("group_member", "test_module", leader, 2, members) == 0,
+                "Create children of the group leader");
+    TEST_ASSERT(dmosi_process_get_group(members[0]) == group && dmosi_process_get_group(members[1]) == group,
+                "Children inherit the group of their parent");
+
+    dmosi_process_t outsider = dmosi_process_create("group_outsider", "test_module", leader);
+    TEST_ASSERT(dmosi_process_set_group(outsider, 0) == 0
+             && dmosi_process_get_group(outsider) == dmosi_process_get_id(outsider),
+                "Set group 0 makes the process lead a new group");
+
+    TEST_ASSERT(dmosi_process_wait_group(group, 0) == -ETIMEDOUT,
+                "Wait on running group with zero timeout returns -ETIMEDOUT");
+    TEST_ASSERT(dmosi_process_kill_group(group, 4) == 3,
+                "Kill group returns number of killed processes");
+    TEST_ASSERT(dmosi_process_get_exit_status(members[1]) == 4,
+                "Group members are killed with the given status");
+    TEST_ASSERT(dmosi_process_get_state(outsider) != DMOSI_PROCESS_STATE_TERMINATED,
+                "Process that left the group keeps running");
+    TEST_ASSERT(dmosi_process_wait_group(group, 100) == 0,
+                "Wait on killed group returns immediately");
+
+    TEST_ASSERT(dmosi_process_set_group(outsider, group) == 0 && dmosi_process_wait_group(group, 0) == -ETIMEDOUT,
+                "Process can join an existing group");
+
+    TEST_ASSERT(dmosi_process_set_group(outsider, 0xFFFF) == -ESRCH && dmosi_process_get_group(outsider) == group,
+                "Set group without members returns -ESRCH");
+    TEST_ASSERT(dmosi_process_kill_group(0, 0) == -EINVAL, "Kill group 0 returns -EINVAL");
+    TEST_ASSERT(dmosi_process_wait_group(0, 0) == -EINVAL, "Wait on group 0 returns -EINVAL");
+    TEST_ASSERT(dmosi_process_set_group(NULL, group) == -EINVAL,
+                "Set group of NULL process returns -EINVAL");
+
+    dmosi_process_destroy(outsider);
+    dmosi_process_destroy(members[0]);
+    dmosi_process_destroy(members[1]);
+    dmosi_process_destroy(leader);
+
+    // The PID of an orphaned group is not handed to a new process
+    leader = dmosi_process_create("orphan_leader", "test_module", NULL);
+    group = dmosi_process_get_id(leader);
+    dmosi_process_t orphan = dmosi_process_create("orphan_member", "test_module", leader);
+    dmosi_process_destroy(leader);
+    dmosi_process_t stranger = dmosi_process_create("orphan_stranger", "test_module", NULL);
+    TEST_ASSERT(dmosi_process_get_id(stranger) != group && dmosi_process_get_group(stranger) != group,
+                "New process does not reuse the PID of an orphaned group");
+    TEST_ASSERT(dmosi_process_set_id(stranger, group) == -EEXIST,
+                "Set ID to the PID of an orphaned group returns -EEXIST");
+    TEST_ASSERT(dmosi_process_kill_group(group, 5) == 1
+             && dmosi_process_get_state(stranger) != DMOSI_PROCESS_STATE_TERMINATED,
+                "Kill orphaned group kills only its remaining member");
+    // A lone member rejoining its orphaned group keeps the group PID reserved
+    TEST_ASSERT(dmosi_process_set_group(orphan, group) == 0 && dmosi_process_get_group(orphan) == group,
+                "Last member can rejoin its orphaned group");
+    dmosi_process_t intruder = dmosi_process_create("orphan_intruder", "test_module", NULL);
+    TEST_ASSERT(dmosi_process_get_id(intruder) != group,
+                "Rejoining an orphaned group does not release its PID");
+    dmosi_process_destroy(intruder);
+    dmosi_process_destroy(orphan);
+    dmosi_process_t reuser = dmosi_process_create("orphan_reuser", "test_module", NULL);
+    TEST_ASSERT(dmosi_process_get_id(reuser) == group,
+                "PID of a group is reused once its last member is destroyed");
+    dmosi_process_destroy(reuser);
+    dmosi_process_destroy(stranger);
+}
+
 // -----------------------------------------
 //
 //      Test: Unique process IDs
@@ -352,6 +884,8 @@ void test_null_inputs(void)
     TEST_ASSERT(dmosi_process_wait(NULL, 0) == -EINVAL,
                 "Wait on NULL process returns -EINVAL");
 
+    // Getters only validate their argument in the checked build
+#if !DMOSI_PROC_FAST_ACCESSORS
     TEST_ASSERT((int)dmosi_process_get_state(NULL) == -EINVAL,
                 "Get state of NULL process returns -EINVAL");
 
@@ -376,6 +910,13 @@ void test_null_inputs(void)
     TEST_ASSERT(dmosi_process_get_pwd(NULL) == NULL,
                 "Get PWD of NULL process returns NULL");
 
+    TEST_ASSERT(dmosi_process_get_module(NULL) == DMOSI_PROCESS_MODULE_INVALID,
+                "Get module of NULL process returns invalid handle");
+#endif
+
+    TEST_ASSERT(dmosi_process_find_module(NULL) == DMOSI_PROCESS_MODULE_INVALID,
+                "Find module by NULL name returns invalid handle");
+
     // NULL name for find_by_name
     TEST_ASSERT(dmosi_process_find_by_name(NULL) == NULL,
                 "Find by NULL name returns NULL");
@@ -430,19 +971,904 @@ void test_process_current_before_start(void)
 
 // -----------------------------------------
 //
-//      Test: Find process by name/ID (without threads)
+//      Test: Find process by name/ID (no processes)
 //
 // -----------------------------------------
 void test_process_find(void)
 {
-    printf("\n=== Testing process find functions (no threads) ===\n");
+    printf("\n=== Testing process find functions (no processes) ===\n");
 
-    // Without threads, find functions should return NULL (no threads to search)
+    // Without processes, find functions should return NULL (nothing registered)
     TEST_ASSERT(dmosi_process_find_by_name("any_proc") == NULL,
-                "Find by name returns NULL when no threads exist");
+                "Find by name returns NULL when no processes exist");
 
     TEST_ASSERT(dmosi_process_find_by_id(1) == NULL,
-                "Find by ID returns NULL when no threads exist");
+                "Find by ID returns NULL when no processes exist");
+}
+
+// -----------------------------------------
+//
+//      Test: Find process by ID through the registry
+//
+// -----------------------------------------
+void test_process_find_by_id(void)
+{
+    printf("\n=== Testing process find by ID ===\n");
+
+    dmosi_process_t proc = dmosi_process_create("find_id_proc", "test_module", NULL);
+    TEST_ASSERT(proc != NULL, "Create process for find by ID test");
+
+    dmosi_process_id_t pid = dmosi_process_get_id(proc);
+    TEST_ASSERT(dmosi_process_find_by_id(pid) == proc,
+                "Find by ID returns process without threads");
+
+    // Changing the ID must move the process in the registry
+    TEST_ASSERT(dmosi_process_set_id(proc, 4242) == 0,
+                "Set process ID to 4242");
+    TEST_ASSERT(dmosi_process_find_by_id(4242) == proc,
+                "Find by new ID returns process");
+    TEST_ASSERT(dmosi_process_find_by_id(pid) == NULL,
+                "Find by old ID returns NULL");
+
+    // Enough processes to force the registry to grow
+    dmosi_process_t procs[100];
+    bool all_created = true;
+    for(int i = 0; i < 100; i++)
+    {
+        procs[i] = dmosi_process_create("find_id_many", "test_module", NULL);
+        all_created = all_created && procs[i] != NULL;
+    }
+    TEST_ASSERT(all_created, "Create 100 processes");
+
+    bool all_found = true;
+    for(int i = 0; i < 100; i++)
+    {
+        all_found = all_found && dmosi_process_find_by_id(dmosi_process_get_id(procs[i])) == procs[i];
+    }
+    TEST_ASSERT(all_found, "Find by ID returns each of 100 processes");
+    TEST_ASSERT(dmosi_process_find_by_id(4242) == proc,
+                "Find by ID still returns original process after registry growth");
+
+    for(int i = 0; i < 100; i++)
+    {
+        dmosi_process_destroy(procs[i]);
+    }
+    dmosi_process_destroy(proc);
+
+    TEST_ASSERT(dmosi_process_find_by_id(4242) == NULL,
+                "Find by ID returns NULL after process is destroyed");
+}
+
+// -----------------------------------------
+//
+//      Test: Find process by name through the name index
+//
+// -----------------------------------------
+void test_process_find_by_name(void)
+{
+    printf("\n=== Testing process find by name ===\n");
+
+    dmosi_process_t alpha = dmosi_process_create("find_name_alpha", "test_module", NULL);
+    dmosi_process_t beta  = dmosi_process_create("find_name_beta", "test_module", NULL);
+    TEST_ASSERT(alpha != NULL && beta != NULL, "Create processes for find by name test");
+
+    TEST_ASSERT(dmosi_process_find_by_name("find_name_alpha") == alpha,
+                "Find by name returns process without threads");
+    TEST_ASSERT(dmosi_process_find_by_name("find_name_beta") == beta,
+                "Find by name distinguishes processes");
+    TEST_ASSERT(dmosi_process_find_by_name("find_name_gamma") == NULL,
+                "Find by unknown name returns NULL");
+
+    // The name index must not be affected by changing the process ID
+    TEST_ASSERT(dmosi_process_set_id(alpha, 777) == 0, "Set ID of named process");
+    TEST_ASSERT(dmosi_process_find_by_name("find_name_alpha") == alpha,
+                "Find by name still works after ID change");
+
+    dmosi_process_destroy(alpha);
+    TEST_ASSERT(dmosi_process_find_by_name("find_name_alpha") == NULL,
+                "Find by name returns NULL after process is destroyed");
+    TEST_ASSERT(dmosi_process_find_by_name("find_name_beta") == beta,
+                "Find by name still returns remaining process");
+
+    dmosi_process_destroy(beta);
+}
+
+// -----------------------------------------
+//
+//      Test: PID recycling and collision detection
+//
+// -----------------------------------------
+void test_process_pid_allocation(void)
+{
+    printf("\n=== Testing process ID allocation ===\n");
+
+    dmosi_process_t first  = dmosi_process_create("pid_first", "test_module", NULL);
+    dmosi_process_t second = dmosi_process_create("pid_second", "test_module", NULL);
+    TEST_ASSERT(first != NULL && second != NULL, "Create processes for PID allocation test");
+
+    // The PID of a destroyed process is handed out again
+    dmosi_process_id_t recycled = dmosi_process_get_id(first);
+    dmosi_process_destroy(first);
+    dmosi_process_t third = dmosi_process_create("pid_third", "test_module", NULL);
+    TEST_ASSERT(third != NULL, "Create process after destroying one");
+    TEST_ASSERT(dmosi_process_get_id(third) == recycled,
+                "Freed PID is recycled by the next process");
+
+    // Explicit IDs must not collide with IDs of other processes
+    TEST_ASSERT(dmosi_process_set_id(second, dmosi_process_get_id(third)) == -EEXIST,
+                "Set ID to an ID in use returns -EEXIST");
+    TEST_ASSERT(dmosi_process_find_by_id(recycled) == third,
+                "Failed set ID leaves the registry unchanged");
+    TEST_ASSERT(dmosi_process_set_id(second, dmosi_process_get_id(second)) == 0,
+                "Set ID to own ID succeeds");
+    TEST_ASSERT(dmosi_process_set_id(second, 0) == -EINVAL,
+                "Set ID to 0 returns -EINVAL");
+
+    // The allocator skips IDs that were claimed explicitly
+    dmosi_process_id_t claimed = dmosi_process_get_id(third) + 1;
+    while(dmosi_process_find_by_id(claimed))
+    {
+        claimed++;
+    }
+    dmosi_process_id_t released = dmosi_process_get_id(second);
+    TEST_ASSERT(dmosi_process_set_id(second, claimed) == 0, "Set ID to a free ID");
+    // The old ID still names the group of the process until it leaves it
+    TEST_ASSERT(dmosi_process_set_group(second, 0) == 0, "Move process to the group of its new ID");
+    dmosi_process_t fourth = dmosi_process_create("pid_fourth", "test_module", NULL);
+    dmosi_process_t fifth  = dmosi_process_create("pid_fifth", "test_module", NULL);
+    TEST_ASSERT(fourth != NULL && fifth != NULL, "Create processes after explicit ID change");
+    TEST_ASSERT(dmosi_process_get_id(fourth) != claimed && dmosi_process_get_id(fifth) != claimed,
+                "Allocator does not hand out explicitly claimed ID");
+    TEST_ASSERT(dmosi_process_get_id(fourth) == released || dmosi_process_get_id(fifth) == released,
+                "ID released by set ID is recycled");
+
+    dmosi_process_destroy(fifth);
+    dmosi_process_destroy(fourth);
+    dmosi_process_destroy(third);
+    dmosi_process_destroy(second);
+}
+
+// -----------------------------------------
+//
+//      Test: Generation-tagged handles
+//
+// -----------------------------------------
+void test_process_handles(void)
+{
+    printf("\n=== Testing generation-tagged handles ===\n");
+
+    dmosi_process_t proc = dmosi_process_create("handle_proc", "test_module", NULL);
+    dmosi_process_handle_t handle = dmosi_process_get_handle(proc);
+    TEST_ASSERT(handle != DMOSI_PROCESS_HANDLE_INVALID, "Get handle of a live process");
+    TEST_ASSERT(dmosi_process_handle_is_valid(handle), "Handle of a live process is valid");
+    TEST_ASSERT(dmosi_process_from_handle(handle) == proc, "Handle resolves to its process");
+
+    dmosi_process_id_t pid = dmosi_process_get_id(proc);
+    dmosi_process_destroy(proc);
+    TEST_ASSERT(!dmosi_process_handle_is_valid(handle), "Handle of a destroyed process is stale");
+    TEST_ASSERT(dmosi_process_from_handle(handle) == NULL, "Stale handle resolves to NULL");
+
+    dmosi_process_t reused = dmosi_process_create("handle_reused", "test_module", NULL);
+    TEST_ASSERT(dmosi_process_get_id(reused) == pid, "New process reuses the PID");
+    TEST_ASSERT(!dmosi_process_handle_is_valid(handle) && dmosi_process_get_handle(reused) != handle,
+                "Handle of the old process does not match the new one");
+
+    handle = dmosi_process_get_handle(reused);
+    dmosi_process_id_t free_pid = pid + 1;
+    while(dmosi_process_find_by_id(free_pid))
+    {
+        free_pid++;
+    }
+    TEST_ASSERT(dmosi_process_set_id(reused, free_pid) == 0 && !dmosi_process_handle_is_valid(handle),
+                "Set ID invalidates handles taken before");
+    TEST_ASSERT(dmosi_process_from_handle(dmosi_process_get_handle(reused)) == reused,
+                "Handle taken after set ID resolves");
+
+    TEST_ASSERT(!dmosi_process_handle_is_valid(DMOSI_PROCESS_HANDLE_INVALID), "Invalid handle is never valid");
+    TEST_ASSERT(dmosi_process_from_handle(((dmosi_process_handle_t)1 << 32) | 0xFFFFFFFFu) == NULL,
+                "Handle with an out of range PID resolves to NULL");
+
+    dmosi_process_destroy(reused);
+}
+
+// -----------------------------------------
+//
+//      Test: Long process names and paths
+//
+// -----------------------------------------
+void test_process_long_strings(void)
+{
+    printf("\n=== Testing long process names and paths ===\n");
+
+    // Longer than the inline buffers of pooled processes
+    const char* long_name = "process_with_a_name_that_does_not_fit_into_the_inline_buffer";
+    const char* long_pwd  = "/a/working/directory/path/that/is/definitely/longer/than/sixty/four/characters";
+
+    dmosi_process_t proc = dmosi_process_create(long_name, "test_module", NULL);
+    TEST_ASSERT(proc != NULL, "Create process with long name");
+    TEST_ASSERT(strcmp(dmosi_process_get_name(proc), long_name) == 0,
+                "Long process name matches");
+    TEST_ASSERT(dmosi_process_find_by_name(long_name) == proc,
+                "Find by long name returns process");
+
+    TEST_ASSERT(dmosi_process_set_pwd(proc, long_pwd) == 0, "Set long PWD");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(proc), long_pwd) == 0,
+                "Long PWD matches");
+    TEST_ASSERT(dmosi_process_set_pwd(proc, "/short") == 0, "Replace long PWD with short one");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(proc), "/short") == 0,
+                "Short PWD matches");
+    TEST_ASSERT(dmosi_process_set_pwd(proc, dmosi_process_get_pwd(proc)) == 0,
+                "Set PWD to its own current value");
+    TEST_ASSERT(strcmp(dmosi_process_get_pwd(proc), "/short") == 0,
+                "PWD unchanged after setting it to itself");
+
+    dmosi_process_destroy(proc);
+
+    // Repeated create/destroy cycles recycle process storage
+    bool cycles_ok = true;
+    for(int i = 0; i < 64 && cycles_ok; i++)
+    {
+        dmosi_process_t cycle = dmosi_process_create("cycle_proc", "test_module", NULL);
+        cycles_ok = cycle != NULL && dmosi_process_set_pwd(cycle, "/tmp") == 0
+                 && strcmp(dmosi_process_get_pwd(cycle), "/tmp") == 0;
+        dmosi_process_destroy(cycle);
+    }
+    TEST_ASSERT(cycles_ok, "64 create/destroy cycles succeed");
+}
+
+// -----------------------------------------
+//
+//      Test: Process tree links and subtree kill
+//
+// -----------------------------------------
+void test_process_tree(void)
+{
+    printf("\n=== Testing process tree ===\n");
+
+    dmosi_process_t root   = dmosi_process_create("tree_root", "test_module", NULL);
+    dmosi_process_t child1 = dmosi_process_create("tree_child1", "test_module", root);
+    dmosi_process_t child2 = dmosi_process_create("tree_child2", "test_module", root);
+    dmosi_process_t grand  = dmosi_process_create("tree_grandchild", "test_module", child1);
+    dmosi_process_t other  = dmosi_process_create("tree_other", "test_module", NULL);
+    TEST_ASSERT(root && child1 && child2 && grand && other, "Create process tree");
+
+    TEST_ASSERT(dmosi_process_get_children(root, NULL, 0) == 2,
+                "Root has two children");
+    TEST_ASSERT(dmosi_process_get_children(child2, NULL, 0) == 0,
+                "Leaf has no children");
+
+    dmosi_process_t children[2] = { NULL, NULL };
+    TEST_ASSERT(dmosi_process_get_children(root, children, 2) == 2,
+                "Get children fills buffer");
+    TEST_ASSERT((children[0] == child1 && children[1] == child2) ||
+                (children[0] == child2 && children[1] == child1),
+                "Children buffer contains both children");
+    TEST_ASSERT(dmosi_process_get_children(root, children, 1) == 1,
+                "Get children respects buffer capacity");
+
+    int visited = 0;
+    for(dmosi_process_t c = dmosi_process_get_first_child(root); c; c = dmosi_process_get_next_sibling(c))
+    {
+        visited++;
+    }
+    TEST_ASSERT(visited == 2, "Sibling iteration visits both children");
+
+    // Killing the tree terminates every descendant and nothing else
+    TEST_ASSERT(dmosi_process_kill(child1, 4) == 0, "Kill one child before the tree");
+    TEST_ASSERT(dmosi_process_kill_tree(root, 9) == 0, "Kill process tree returns 0");
+    TEST_ASSERT(dmosi_process_get_state(root) == DMOSI_PROCESS_STATE_TERMINATED &&
+                dmosi_process_get_state(child1) == DMOSI_PROCESS_STATE_TERMINATED &&
+                dmosi_process_get_state(child2) == DMOSI_PROCESS_STATE_TERMINATED &&
+                dmosi_process_get_state(grand) == DMOSI_PROCESS_STATE_TERMINATED,
+                "All processes in the tree are TERMINATED");
+    TEST_ASSERT(dmosi_process_get_exit_status(grand) == 9,
+                "Descendant exit status is set to kill status");
+    TEST_ASSERT(dmosi_process_get_exit_status(child1) == 4,
+                "Descendant that terminated before the tree kill keeps its exit status");
+    TEST_ASSERT(dmosi_process_get_state(other) == DMOSI_PROCESS_STATE_RUNNING,
+                "Process outside the tree keeps running");
+
+    // Destroying a child unlinks it from its parent
+    dmosi_process_destroy(child2);
+    TEST_ASSERT(dmosi_process_get_children(root, NULL, 0) == 1,
+                "Destroyed child is removed from parent");
+
+    // Destroying a parent detaches its children
+    dmosi_process_destroy(child1);
+    TEST_ASSERT(dmosi_process_get_parent(grand) == NULL,
+                "Children of a destroyed parent are detached");
+    TEST_ASSERT(dmosi_process_get_first_child(root) == NULL,
+                "Root has no children left");
+
+    TEST_ASSERT(dmosi_process_kill_tree(NULL, 0) == -EINVAL,
+                "Kill tree of NULL process returns -EINVAL");
+
+    dmosi_process_destroy(grand);
+    dmosi_process_destroy(root);
+    dmosi_process_destroy(other);
+}
+
+// -----------------------------------------
+//
+//      Test: Creating children of a process being destroyed
+//
+// -----------------------------------------
+#define DESTROY_RACE_CHILDREN   256
+
+static struct
+{
+    dmosi_process_t parent;
+    _Atomic bool parent_gone;
+    _Atomic bool stopped;
+    _Atomic bool waiting;
+    dmosi_process_t children[DESTROY_RACE_CHILDREN];
+    size_t count;
+} destroy_race;
+
+static void* destroy_race_spawner(void* arg)
+{
+    (void)arg;
+    while(!atomic_load(&destroy_race.parent_gone) && destroy_race.count < DESTROY_RACE_CHILDREN)
+    {
+        dmosi_process_t child = dmosi_process_create("race_child", "test_module", destroy_race.parent);
+        if(child)
+        {
+            destroy_race.children[destroy_race.count++] = child;
+        }
+    }
+    atomic_store(&destroy_race.stopped, true);
+    return NULL;
+}
+
+// Keeps destroy draining waiters for a while, so children are created while the parent is dying
+static void* destroy_race_waiter(void* arg)
+{
+    (void)arg;
+    atomic_store(&destroy_race.waiting, true);
+    dmosi_process_wait(destroy_race.parent, 5000);
+    return NULL;
+}
+
+// Runs in destroy before the parent is freed, so the spawner never touches freed memory
+static void destroy_race_gate(dmosi_process_t process, int exit_status, void* context)
+{
+    (void)process;
+    (void)exit_status;
+    (void)context;
+    atomic_store(&destroy_race.parent_gone, true);
+    while(!atomic_load(&destroy_race.stopped))
+    {
+        sched_yield();
+    }
+}
+
+void test_process_destroy_race(void)
+{
+    printf("\n=== Testing children created during destroy ===\n");
+
+    bool detached = true;
+    bool spawned = true;
+    for(int round = 0; round < 10; round++)
+    {
+        destroy_race.parent = dmosi_process_create("race_parent", "test_module", NULL);
+        atomic_store(&destroy_race.parent_gone, false);
+        atomic_store(&destroy_race.stopped, false);
+        atomic_store(&destroy_race.waiting, false);
+        destroy_race.count = 0;
+        dmosi_process_add_exit_callback(destroy_race.parent, destroy_race_gate, NULL);
+
+        pthread_t spawner;
+        pthread_t waiter;
+        spawned = spawned && pthread_create(&waiter, NULL, destroy_race_waiter, NULL) == 0;
+        while(!atomic_load(&destroy_race.waiting))
+        {
+            sched_yield();
+        }
+        dmosi_thread_sleep(1);
+        spawned = spawned && pthread_create(&spawner, NULL, destroy_race_spawner, NULL) == 0;
+        dmosi_process_destroy(destroy_race.parent);
+        pthread_join(spawner, NULL);
+        pthread_join(waiter, NULL);
+
+        for(size_t i = 0; i < destroy_race.count; i++)
+        {
+            detached = detached && dmosi_process_get_parent(destroy_race.children[i]) == NULL;
+            dmosi_process_destroy(destroy_race.children[i]);
+        }
+    }
+    TEST_ASSERT(spawned, "Start threads creating children during destroy");
+    TEST_ASSERT(detached, "No child keeps a parent that has been destroyed");
+}
+
+// -----------------------------------------
+//
+//      Test: Batch process creation
+//
+// -----------------------------------------
+void test_process_create_many(void)
+{
+    printf("\n=== Testing batch process creation ===\n");
+
+    dmosi_process_t parent = dmosi_process_create("pool_parent", "test_module", NULL);
+    dmosi_process_t workers[12];
+    TEST_ASSERT(dmosi_process_create_many("worker", "pool_module", parent, 12, workers) == 0,
+                "Create 12 processes in batch");
+
+    TEST_ASSERT(strcmp(dmosi_process_get_name(workers[0]), "worker0") == 0 &&
+                strcmp(dmosi_process_get_name(workers[11]), "worker11") == 0,
+                "Batch process names carry their index");
+    TEST_ASSERT(strcmp(dmosi_process_get_module_name(workers[5]), "pool_module") == 0,
+                "Batch process module name matches");
+
+    bool contiguous = true;
+    for(int i = 1; i < 12; i++)
+    {
+        contiguous = contiguous && dmosi_process_get_id(workers[i]) == dmosi_process_get_id(workers[0]) + i;
+    }
+    TEST_ASSERT(contiguous, "Batch processes have contiguous IDs");
+
+    TEST_ASSERT(dmosi_process_find_by_name("worker7") == workers[7],
+                "Find by name returns batch process");
+    TEST_ASSERT(dmosi_process_find_by_id(dmosi_process_get_id(workers[3])) == workers[3],
+                "Find by ID returns batch process");
+    TEST_ASSERT(dmosi_process_get_children(parent, NULL, 0) == 12,
+                "Batch processes are children of the parent");
+    TEST_ASSERT(dmosi_process_get_state(workers[11]) == DMOSI_PROCESS_STATE_RUNNING,
+                "Batch process is RUNNING");
+
+    // Batch processes are destroyed individually, in any order
+    for(int i = 11; i >= 0; i--)
+    {
+        dmosi_process_destroy(workers[i]);
+    }
+    TEST_ASSERT(dmosi_process_find_by_name("worker7") == NULL,
+                "Destroyed batch process is no longer found");
+    TEST_ASSERT(dmosi_process_get_children(parent, NULL, 0) == 0,
+                "Parent has no children after batch is destroyed");
+
+    TEST_ASSERT(dmosi_process_create_many(NULL, "pool_module", NULL, 4, workers) == -EINVAL,
+                "Batch create with NULL prefix returns -EINVAL");
+    TEST_ASSERT(dmosi_process_create_many("worker", "pool_module", NULL, 0, workers) == -EINVAL,
+                "Batch create of zero processes returns -EINVAL");
+
+    dmosi_process_destroy(parent);
+}
+
+// -----------------------------------------
+//
+//      Test: Process enumeration
+//
+// -----------------------------------------
+static bool count_visitor(dmosi_process_t process, void* context)
+{
+    (void)process;
+    (*(int*)context)++;
+    return true;
+}
+
+static bool stop_visitor(dmosi_process_t process, void* context)
+{
+    (void)process;
+    (*(int*)context)++;
+    return false;
+}
+
+void test_process_enumeration(void)
+{
+    printf("\n=== Testing process enumeration ===\n");
+
+    TEST_ASSERT(dmosi_process_get_all(NULL, 0) == 0,
+                "No processes are listed before any is created");
+
+    dmosi_process_t procs[3];
+    for(int i = 0; i < 3; i++)
+    {
+        procs[i] = dmosi_process_create("enum_proc", "test_module", NULL);
+    }
+    TEST_ASSERT(procs[0] && procs[1] && procs[2], "Create processes for enumeration");
+
+    TEST_ASSERT(dmosi_process_get_all(NULL, 0) == 3,
+                "Get all returns process count");
+
+    dmosi_process_t listed[3] = { NULL, NULL, NULL };
+    TEST_ASSERT(dmosi_process_get_all(listed, 3) == 3, "Get all fills buffer");
+    bool all_listed = true;
+    for(int i = 0; i < 3; i++)
+    {
+        all_listed = all_listed && (listed[0] == procs[i] || listed[1] == procs[i] || listed[2] == procs[i]);
+    }
+    TEST_ASSERT(all_listed, "Every process is listed exactly once");
+    TEST_ASSERT(dmosi_process_get_all(listed, 2) == 2,
+                "Get all respects buffer capacity");
+
+    int visited = 0;
+    TEST_ASSERT(dmosi_process_for_each(count_visitor, &visited) == 3 && visited == 3,
+                "For each visits every process");
+
+    visited = 0;
+    TEST_ASSERT(dmosi_process_for_each(stop_visitor, &visited) == 1 && visited == 1,
+                "For each stops when the visitor returns false");
+
+    TEST_ASSERT(dmosi_process_for_each(NULL, NULL) == 0,
+                "For each with NULL visitor returns 0");
+
+    for(int i = 0; i < 3; i++)
+    {
+        dmosi_process_destroy(procs[i]);
+    }
+    TEST_ASSERT(dmosi_process_get_all(NULL, 0) == 0,
+                "No processes are listed after all are destroyed");
+}
+
+// -----------------------------------------
+//
+//      Test: Process queries
+//
+// -----------------------------------------
+void test_process_query(void)
+{
+    printf("\n=== Testing process queries ===\n");
+
+    dmosi_process_t parent = dmosi_process_create("query_parent", "query_module", NULL);
+    dmosi_process_t children[3];
+    TEST_ASSERT(dmosi_process_create_many("query_child", "query_module", parent, 3, children) == 0,
+                "Create processes for query test");
+    dmosi_process_t other = dmosi_process_create("query_other", "test_module", NULL);
+    dmosi_process_set_uid(children[0], 42);
+    dmosi_process_set_uid(children[1], 42);
+    dmosi_process_set_uid(other, 42);
+    dmosi_process_kill(children[1], 0);
+
+    dmosi_process_query_t query = {
+        .fields = DMOSI_PROCESS_QUERY_UID | DMOSI_PROCESS_QUERY_STATE | DMOSI_PROCESS_QUERY_MODULE,
+        .uid    = 42,
+        .state  = DMOSI_PROCESS_STATE_RUNNING,
+        .module = dmosi_process_find_module("query_module"),
+    };
+    dmosi_process_t found[4] = { NULL };
+    TEST_ASSERT(dmosi_process_query(&query, NULL, 0) == 1, "Query counts processes meeting all criteria");
+    TEST_ASSERT(dmosi_process_query(&query, found, 4) == 1 && found[0] == children[0],
+                "Query returns the matching process");
+
+    query.fields = DMOSI_PROCESS_QUERY_PARENT;
+    query.parent = parent;
+    TEST_ASSERT(dmosi_process_query(&query, NULL, 0) == 3, "Query by parent");
+    TEST_ASSERT(dmosi_process_query(&query, found, 2) == 2, "Query respects buffer capacity");
+
+    query.fields = DMOSI_PROCESS_QUERY_NAME;
+    query.name   = "query_other";
+    TEST_ASSERT(dmosi_process_query(&query, found, 4) == 1 && found[0] == other, "Query by name");
+
+    int visited = 0;
+    query.fields = DMOSI_PROCESS_QUERY_UID;
+    TEST_ASSERT(dmosi_process_query_each(&query, count_visitor, &visited) == 3 && visited == 3,
+                "Query each visits every matching process");
+
+    query.fields = DMOSI_PROCESS_QUERY_MODULE;
+    query.module = DMOSI_PROCESS_MODULE_INVALID;
+    TEST_ASSERT(dmosi_process_query(&query, NULL, 0) == 0, "Query by unknown module matches nothing");
+
+    query.fields = 0;
+    TEST_ASSERT(dmosi_process_query(&query, NULL, 0) == 5, "Query without criteria matches every process");
+    TEST_ASSERT(dmosi_process_query(NULL, NULL, 0) == 0, "Query with NULL criteria returns 0");
+    TEST_ASSERT(dmosi_process_query_each(&query, NULL, NULL) == 0, "Query each with NULL visitor returns 0");
+
+    dmosi_process_destroy(other);
+    for(int i = 0; i < 3; i++)
+    {
+        dmosi_process_destroy(children[i]);
+    }
+    dmosi_process_destroy(parent);
+}
+
+// -----------------------------------------
+//
+//      Test: Process resource accounting
+//
+// -----------------------------------------
+void test_process_usage(void)
+{
+    printf("\n=== Testing process resource accounting ===\n");
+
+    dmosi_process_t proc = dmosi_process_create("usage_proc", "test_module", NULL);
+    TEST_ASSERT(proc != NULL, "Create process for accounting test");
+
+    dmosi_process_usage_t usage;
+    TEST_ASSERT(dmosi_process_get_usage(proc, &usage) == 0, "Get usage returns 0");
+    TEST_ASSERT(usage.allocated_bytes == 0 && usage.peak_bytes == 0 && usage.cpu_ticks == 0,
+                "New process has no usage");
+    TEST_ASSERT(usage.thread_count == 0, "New process has no threads");
+
+    dmosi_process_account_alloc(proc, 100);
+    dmosi_process_account_alloc(proc, 50);
+    dmosi_process_account_free(proc, 120);
+    dmosi_process_account_cpu(proc, 7);
+    dmosi_process_account_cpu(proc, 5);
+
+    TEST_ASSERT(dmosi_process_get_usage(proc, &usage) == 0, "Get usage after accounting");
+    TEST_ASSERT(usage.allocated_bytes == 30, "Allocated bytes track allocations and frees");
+    TEST_ASSERT(usage.peak_bytes == 150, "Peak bytes keep the highest value");
+    TEST_ASSERT(usage.cpu_ticks == 12, "CPU ticks accumulate");
+
+    TEST_ASSERT(dmosi_process_get_usage(NULL, &usage) == -EINVAL,
+                "Get usage of NULL process returns -EINVAL");
+    TEST_ASSERT(dmosi_process_get_usage(proc, NULL) == -EINVAL,
+                "Get usage into NULL buffer returns -EINVAL");
+
+    dmosi_process_destroy(proc);
+}
+
+// -----------------------------------------
+//
+//      Test: Process memory quota
+//
+// -----------------------------------------
+void test_process_memory_quota(void)
+{
+    printf("\n=== Testing process memory quota ===\n");
+
+    dmosi_process_t limited = dmosi_process_create("quota_limited", "test_module", NULL);
+    dmosi_process_t other = dmosi_process_create("quota_other", "test_module", NULL);
+    TEST_ASSERT(limited != NULL && other != NULL, "Create processes for quota test");
+
+    TEST_ASSERT(dmosi_process_reserve_memory(limited, 1000) == 0, "Reserve without quota succeeds");
+    dmosi_process_account_free(limited, 1000);
+
+    TEST_ASSERT(dmosi_process_set_memory_limit(limited, 256) == 0, "Set memory limit");
+    TEST_ASSERT(dmosi_process_reserve_memory(limited, 200) == 0, "Reserve within quota succeeds");
+    TEST_ASSERT(dmosi_process_reserve_memory(limited, 100) == -ENOMEM, "Reserve over quota returns -ENOMEM");
+    TEST_ASSERT(dmosi_process_reserve_memory(other, 100) == 0, "Quota of one process does not affect others");
+
+    dmosi_process_usage_t usage;
+    dmosi_process_get_usage(limited, &usage);
+    TEST_ASSERT(usage.allocated_bytes == 200 && usage.memory_limit == 256,
+                "Rejected reservation is not charged");
+
+    dmosi_process_account_free(limited, 150);
+    TEST_ASSERT(dmosi_process_reserve_memory(limited, 100) == 0, "Reserve succeeds again after memory is freed");
+    TEST_ASSERT(dmosi_process_reserve_memory(limited, (size_t)-1) == -ENOMEM,
+                "Reservation that overflows is rejected");
+
+    TEST_ASSERT(dmosi_process_set_memory_limit(NULL, 1) == -EINVAL, "Set memory limit of NULL process returns -EINVAL");
+    TEST_ASSERT(dmosi_process_reserve_memory(NULL, 1) == -EINVAL, "Reserve memory for NULL process returns -EINVAL");
+
+    dmosi_process_destroy(other);
+    dmosi_process_destroy(limited);
+}
+
+// -----------------------------------------
+//
+//      Test: Per-process thread registry
+//
+// -----------------------------------------
+void test_process_thread_registry(void)
+{
+    printf("\n=== Testing process thread registry ===\n");
+
+    dmosi_process_t proc = dmosi_process_create("registry_proc", "test_module", NULL);
+    TEST_ASSERT(proc != NULL, "Create process for thread registry test");
+
+    // The handles are only stored, never used, so any distinct pointers will do
+    static int fake_threads[3];
+    dmosi_process_thread_link_t links[3];
+    bool attached = true;
+    for(int i = 0; i < 3; i++)
+    {
+        attached = attached && dmosi_process_attach_thread(proc, (dmosi_thread_t)&fake_threads[i], &links[i]) == 0;
+    }
+    TEST_ASSERT(attached, "Attach three threads");
+    TEST_ASSERT(dmosi_process_get_thread_count(proc) == 3, "Thread count is 3 after attach");
+
+    dmosi_process_usage_t usage;
+    TEST_ASSERT(dmosi_process_get_usage(proc, &usage) == 0 && usage.thread_count == 3,
+                "Usage reports attached threads");
+
+    dmosi_process_detach_thread(&links[1]);
+    TEST_ASSERT(dmosi_process_get_thread_count(proc) == 2, "Thread count is 2 after detaching one thread");
+    dmosi_process_detach_thread(&links[1]);
+    TEST_ASSERT(dmosi_process_get_thread_count(proc) == 2, "Detaching a thread twice is a no-op");
+
+    dmosi_process_detach_thread(&links[0]);
+    dmosi_process_detach_thread(&links[2]);
+    TEST_ASSERT(dmosi_process_get_thread_count(proc) == 0, "Thread count is 0 after detaching all threads");
+    TEST_ASSERT(links[0].process == NULL && links[2].process == NULL, "Detached links are cleared");
+
+    TEST_ASSERT(dmosi_process_attach_thread(proc, NULL, &links[0]) == -EINVAL,
+                "Attach NULL thread returns -EINVAL");
+    TEST_ASSERT(dmosi_process_attach_thread(NULL, (dmosi_thread_t)&fake_threads[0], &links[0]) == -EINVAL,
+                "Attach thread to NULL process returns -EINVAL");
+
+    dmosi_process_destroy(proc);
+}
+
+// -----------------------------------------
+//
+//      Test: Process scheduling attributes
+//
+// -----------------------------------------
+static int sched_calls = 0;
+static int sched_last_priority = 0;
+static uint32_t sched_last_affinity = 0;
+
+static int record_sched(dmosi_thread_t thread, int priority, uint32_t affinity)
+{
+    (void)thread;
+    sched_calls++;
+    sched_last_priority = priority;
+    sched_last_affinity = affinity;
+    return 0;
+}
+
+void test_process_sched(void)
+{
+    printf("\n=== Testing process scheduling attributes ===\n");
+
+    dmosi_process_t proc = dmosi_process_create("sched_proc", "test_module", NULL);
+    TEST_ASSERT(dmosi_process_get_priority(proc) == DMOSI_PROCESS_PRIORITY_UNSET
+             && dmosi_process_get_affinity(proc) == DMOSI_PROCESS_AFFINITY_ANY,
+                "New process has no scheduling attributes");
+
+    dmosi_process_set_sched_handler(record_sched);
+    static int fake_threads[2];
+    dmosi_process_thread_link_t links[2];
+    dmosi_process_attach_thread(proc, (dmosi_thread_t)&fake_threads[0], &links[0]);
+    TEST_ASSERT(sched_calls == 0, "Attaching a thread to a process without attributes applies nothing");
+    dmosi_process_attach_thread(proc, (dmosi_thread_t)&fake_threads[1], &links[1]);
+
+    TEST_ASSERT(dmosi_process_set_sched(proc, 5, 0x3) == 0, "Set scheduling attributes");
+    TEST_ASSERT(sched_calls == 2 && sched_last_priority == 5 && sched_last_affinity == 0x3,
+                "Attributes are re-applied to every existing thread");
+    TEST_ASSERT(dmosi_process_set_affinity(proc, 0x4) == 0 && dmosi_process_get_priority(proc) == 5
+             && dmosi_process_get_affinity(proc) == 0x4,
+                "Set affinity keeps the priority");
+
+    dmosi_process_t child = dmosi_process_create("sched_child", "test_module", proc);
+    TEST_ASSERT(dmosi_process_get_priority(child) == 5 && dmosi_process_get_affinity(child) == 0x4,
+                "Child process inherits scheduling attributes");
+
+    static int child_thread;
+    dmosi_process_thread_link_t child_link;
+    sched_calls = 0;
+    dmosi_process_attach_thread(child, (dmosi_thread_t)&child_thread, &child_link);
+    TEST_ASSERT(sched_calls == 1 && sched_last_priority == 5 && sched_last_affinity == 0x4,
+                "New thread inherits the attributes of its process");
+
+    TEST_ASSERT(dmosi_process_set_priority(NULL, 1) == -EINVAL, "Set priority of NULL process returns -EINVAL");
+
+    dmosi_process_set_sched_handler(NULL);
+    dmosi_process_detach_thread(&child_link);
+    dmosi_process_detach_thread(&links[0]);
+    dmosi_process_detach_thread(&links[1]);
+    dmosi_process_destroy(child);
+    dmosi_process_destroy(proc);
+}
+
+// -----------------------------------------
+//
+//      Test: Statistics export
+//
+// -----------------------------------------
+void test_process_export_stats(void)
+{
+    printf("\n=== Testing process statistics export ===\n");
+
+    dmosi_process_t parent = dmosi_process_create("stats_parent_with_a_long_name", "test_module", NULL);
+    dmosi_process_t child = dmosi_process_create("stats_child", "test_module", parent);
+    TEST_ASSERT(parent != NULL && child != NULL, "Create processes for stats export");
+    dmosi_process_set_uid(child, 7);
+    dmosi_process_account_alloc(child, 64);
+    dmosi_process_account_cpu(child, 3);
+    static int fake_threads[2];
+    dmosi_process_thread_link_t links[2];
+    dmosi_process_attach_thread(child, (dmosi_thread_t)&fake_threads[0], &links[0]);
+    dmosi_process_attach_thread(child, (dmosi_thread_t)&fake_threads[1], &links[1]);
+    dmosi_process_kill(parent, 5);
+
+    TEST_ASSERT(dmosi_process_export_stats(NULL, 0) == 2, "Export without buffer returns process count");
+
+    dmosi_process_stats_t stats[3];
+    TEST_ASSERT(dmosi_process_export_stats(stats, 3) == 2, "Export writes one record per process");
+    dmosi_process_stats_t* child_stats = stats[0].pid == dmosi_process_get_id(child) ? &stats[0] : &stats[1];
+    dmosi_process_stats_t* parent_stats = child_stats == &stats[0] ? &stats[1] : &stats[0];
+    TEST_ASSERT(child_stats->pid == dmosi_process_get_id(child)
+             && child_stats->parent_pid == dmosi_process_get_id(parent)
+             && child_stats->uid == 7
+             && child_stats->module == dmosi_process_get_module(child)
+             && strcmp(child_stats->name, "stats_child") == 0,
+                "Record holds the identity of the process");
+    TEST_ASSERT(child_stats->allocated_bytes == 64 && child_stats->cpu_ticks == 3 && child_stats->thread_count == 2,
+                "Record holds the resource usage of the process");
+    TEST_ASSERT(parent_stats->state == DMOSI_PROCESS_STATE_TERMINATED && parent_stats->exit_status == 5,
+                "Record holds the state and exit status");
+    TEST_ASSERT(strlen(parent_stats->name) == DMOSI_PROCESS_STATS_NAME_LENGTH - 1
+             && strncmp(parent_stats->name, "stats_parent_with_a_long_name", DMOSI_PROCESS_STATS_NAME_LENGTH - 1) == 0,
+                "Long names are truncated");
+    TEST_ASSERT(dmosi_process_export_stats(stats, 1) == 1, "Export respects buffer capacity");
+
+    dmosi_process_detach_thread(&links[0]);
+    dmosi_process_detach_thread(&links[1]);
+    dmosi_process_destroy(child);
+    dmosi_process_destroy(parent);
+}
+
+// -----------------------------------------
+//
+//      Test: Lifecycle tracing
+//
+// -----------------------------------------
+static uint64_t test_clock_value = 1000;
+
+static uint64_t test_clock(void)
+{
+    return test_clock_value++;
+}
+
+void test_process_trace(void)
+{
+    printf("\n=== Testing lifecycle tracing ===\n");
+
+    dmosi_process_trace_record_t records[256];
+    dmosi_process_trace_set_clock(test_clock);
+
+    dmosi_process_t proc = dmosi_process_create("trace_proc", "test_module", NULL);
+    TEST_ASSERT(proc != NULL, "Create process for trace test");
+    dmosi_process_id_t pid = dmosi_process_get_id(proc);
+
+    dmosi_process_find_by_id(pid);
+    dmosi_process_kill(proc, 5);
+    dmosi_process_wait(proc, 0);
+    dmosi_process_destroy(proc);
+
+    size_t count = dmosi_process_trace_read(records, 256);
+#if DMOSI_PROC_TRACE_SIZE > 0
+    static const uint8_t expected[] = {
+        DMOSI_PROCESS_TRACE_CREATE, DMOSI_PROCESS_TRACE_FIND, DMOSI_PROCESS_TRACE_KILL,
+        DMOSI_PROCESS_TRACE_WAIT_ENTER, DMOSI_PROCESS_TRACE_WAIT_EXIT, DMOSI_PROCESS_TRACE_DESTROY,
+    };
+    // A small ring only keeps the newest events
+    size_t n = sizeof(expected) / sizeof(expected[0]);
+    n = n < DMOSI_PROC_TRACE_SIZE ? n : DMOSI_PROC_TRACE_SIZE;
+    const uint8_t* tail = &expected[sizeof(expected) / sizeof(expected[0]) - n];
+    TEST_ASSERT(count >= n, "Trace contains the recorded events");
+
+    bool sequence_ok = count >= n;
+    for(size_t i = 0; sequence_ok && i < n; i++)
+    {
+        const dmosi_process_trace_record_t* r = &records[count - n + i];
+        sequence_ok = r->event == tail[i] && r->pid == pid;
+    }
+    TEST_ASSERT(sequence_ok, "Trace records lifecycle events in order with the process ID");
+    TEST_ASSERT(count < 4 || records[count - 4].event != DMOSI_PROCESS_TRACE_KILL || records[count - 4].arg == 5,
+                "Kill event records the status");
+    TEST_ASSERT(count >= 2 && records[count - 1].timestamp > records[count - 2].timestamp,
+                "Trace records are timestamped with the trace clock");
+#endif
+
+    // Every process of a batch records its own create event
+    dmosi_process_t batch[3];
+    TEST_ASSERT(dmosi_process_create_many("trace_batch", "test_module", NULL, 3, batch) == 0,
+                "Create batch for trace test");
+    count = dmosi_process_trace_read(records, 256);
+#if DMOSI_PROC_TRACE_SIZE > 0
+    n = 3 < DMOSI_PROC_TRACE_SIZE ? 3 : DMOSI_PROC_TRACE_SIZE;
+    bool batch_ok = count >= n;
+    for(size_t i = 0; batch_ok && i < n; i++)
+    {
+        const dmosi_process_trace_record_t* r = &records[count - n + i];
+        batch_ok = r->event == DMOSI_PROCESS_TRACE_CREATE && r->pid == dmosi_process_get_id(batch[3 - n + i]);
+    }
+    TEST_ASSERT(batch_ok, "Batch creation records a create event per process");
+#else
+    TEST_ASSERT(count == 0, "Nothing is recorded when tracing is disabled");
+#endif
+    for(int i = 0; i < 3; i++)
+    {
+        dmosi_process_destroy(batch[i]);
+    }
+
+    dmosi_process_trace_set_clock(NULL);
+    TEST_ASSERT(dmosi_process_trace_read(NULL, 16) == 0,
+                "Trace read into NULL buffer returns 0");
 }
 
 // -----------------------------------------
@@ -461,15 +1887,39 @@ int main(void)
     test_process_parent_child();
     test_process_uid();
     test_process_pwd();
+    test_process_pwd_inheritance();
     test_process_exit_status();
     test_process_id();
     test_process_module_name();
+    test_process_module_handles();
+    test_process_kill_module();
     test_process_kill();
     test_process_wait();
+    test_process_wait_many();
+    test_process_exit_callbacks();
+    test_process_reaper();
+    test_process_kill_tree_reaped();
+    test_process_groups();
     test_process_unique_ids();
     test_null_inputs();
     test_process_current_before_start();
     test_process_find();
+    test_process_find_by_id();
+    test_process_find_by_name();
+    test_process_pid_allocation();
+    test_process_handles();
+    test_process_long_strings();
+    test_process_tree();
+    test_process_destroy_race();
+    test_process_create_many();
+    test_process_enumeration();
+    test_process_query();
+    test_process_usage();
+    test_process_memory_quota();
+    test_process_thread_registry();
+    test_process_sched();
+    test_process_export_stats();
+    test_process_trace();
 
     printf("\n========================================\n");
     printf("  Test Summary\n");